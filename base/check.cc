@@ -0,0 +1,14 @@
+#include "base/check.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace base::internal {
+
+void CheckFailure(const char* condition, const char* file, int line) {
+  std::fprintf(stderr, "%s:%d: Check failed: %s\n", file, line, condition);
+  std::fflush(stderr);
+  std::abort();
+}
+
+}  // namespace base::internal
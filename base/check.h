@@ -0,0 +1,38 @@
+#ifndef BASE_CHECK_H_
+#define BASE_CHECK_H_
+
+// Minimal stand-ins for Chromium's CHECK family. Failures print the condition
+// and source position and then abort; there is no message streaming.
+
+namespace base::internal {
+
+[[noreturn]] void CheckFailure(const char* condition,
+                               const char* file,
+                               int line);
+
+}  // namespace base::internal
+
+#define CHECK(condition)                                                \
+  do {                                                                  \
+    if (!(condition)) [[unlikely]] {                                    \
+      ::base::internal::CheckFailure(#condition, __FILE__, __LINE__);   \
+    }                                                                   \
+  } while (false)
+
+#if defined(NDEBUG)
+#define DCHECK_IS_ON() 0
+#define DCHECK(condition) \
+  do {                    \
+    if (false) {          \
+      (void)(condition);  \
+    }                     \
+  } while (false)
+#else
+#define DCHECK_IS_ON() 1
+#define DCHECK(condition) CHECK(condition)
+#endif
+
+#define NOTREACHED() \
+  ::base::internal::CheckFailure("NOTREACHED()", __FILE__, __LINE__)
+
+#endif  // BASE_CHECK_H_
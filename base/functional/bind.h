@@ -0,0 +1,35 @@
+#ifndef BASE_FUNCTIONAL_BIND_H_
+#define BASE_FUNCTIONAL_BIND_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "base/functional/bind_internal.h"
+#include "base/functional/callback.h"
+
+namespace base {
+
+// Binds `args` to the leading parameters of `functor` and returns a
+// `OnceCallback` taking the remaining parameters. Bound arguments are moved
+// into the functor when the callback runs. If `functor` is a method and the
+// first bound argument is a `WeakPtr`, the call is skipped once the weak
+// pointer has been invalidated.
+template <typename Functor, typename... Args>
+auto BindOnce(Functor&& functor, Args&&... args) {
+  using FunctorType = std::decay_t<Functor>;
+  using BindStateType =
+      internal::BindState<FunctorType, std::decay_t<Args>...>;
+  using UnboundRunType =
+      internal::MakeUnboundRunType<FunctorType, std::decay_t<Args>...>;
+  using InvokerType = internal::Invoker<BindStateType, UnboundRunType>;
+
+  return OnceCallback<UnboundRunType>(
+      std::make_unique<BindStateType>(std::forward<Functor>(functor),
+                                      std::forward<Args>(args)...),
+      &InvokerType::RunOnce);
+}
+
+}  // namespace base
+
+#endif  // BASE_FUNCTIONAL_BIND_H_
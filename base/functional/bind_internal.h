@@ -0,0 +1,203 @@
+#ifndef BASE_FUNCTIONAL_BIND_INTERNAL_H_
+#define BASE_FUNCTIONAL_BIND_INTERNAL_H_
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "base/functional/callback.h"
+
+namespace base {
+
+template <typename T>
+class WeakPtr;
+
+namespace internal {
+
+template <typename... Ts>
+struct TypeList {};
+
+// Drops the first `n` types from a `TypeList`.
+template <size_t n, typename List>
+struct DropTypeListItemImpl;
+
+template <size_t n, typename T, typename... Ts>
+  requires(n > 0)
+struct DropTypeListItemImpl<n, TypeList<T, Ts...>>
+    : DropTypeListItemImpl<n - 1, TypeList<Ts...>> {};
+
+template <typename... Ts>
+struct DropTypeListItemImpl<0, TypeList<Ts...>> {
+  using Type = TypeList<Ts...>;
+};
+
+template <typename R, typename List>
+struct MakeFunctionTypeImpl;
+
+template <typename R, typename... Args>
+struct MakeFunctionTypeImpl<R, TypeList<Args...>> {
+  using Type = R(Args...);
+};
+
+template <typename T>
+struct IsWeakPtr : std::false_type {};
+
+template <typename T>
+struct IsWeakPtr<WeakPtr<T>> : std::true_type {};
+
+template <typename T>
+struct IsOnceCallback : std::false_type {};
+
+template <typename Signature>
+struct IsOnceCallback<OnceCallback<Signature>> : std::true_type {};
+
+// Extracts the run type of a lambda or other functor from the type of its
+// `operator()`.
+template <typename Method>
+struct CallOperatorTraits;
+
+template <typename R, typename Class, typename... Args>
+struct CallOperatorTraits<R (Class::*)(Args...)> {
+  using RunType = R(Args...);
+};
+
+template <typename R, typename Class, typename... Args>
+struct CallOperatorTraits<R (Class::*)(Args...) const> {
+  using RunType = R(Args...);
+};
+
+// Describes how a functor is invoked. For methods, the receiver is the first
+// run argument.
+template <typename Functor, typename = void>
+struct FunctorTraits;
+
+template <typename R, typename... Args>
+struct FunctorTraits<R (*)(Args...)> {
+  using RunType = R(Args...);
+  using ReturnType = R;
+  using ArgList = TypeList<Args...>;
+  static constexpr bool is_method = false;
+};
+
+template <typename R, typename Receiver, typename... Args>
+struct FunctorTraits<R (Receiver::*)(Args...)> {
+  using RunType = R(Receiver*, Args...);
+  using ReturnType = R;
+  using ArgList = TypeList<Receiver*, Args...>;
+  static constexpr bool is_method = true;
+};
+
+template <typename R, typename Receiver, typename... Args>
+struct FunctorTraits<R (Receiver::*)(Args...) const> {
+  using RunType = R(const Receiver*, Args...);
+  using ReturnType = R;
+  using ArgList = TypeList<const Receiver*, Args...>;
+  static constexpr bool is_method = true;
+};
+
+template <typename Functor>
+struct FunctorTraits<Functor, std::void_t<decltype(&Functor::operator())>>
+    : FunctorTraits<typename std::add_pointer_t<
+          typename CallOperatorTraits<decltype(&Functor::operator())>::RunType>> {
+  static constexpr bool is_method = false;
+};
+
+template <typename R, typename... Args>
+struct FunctorTraits<OnceCallback<R(Args...)>> {
+  using RunType = R(Args...);
+  using ReturnType = R;
+  using ArgList = TypeList<Args...>;
+  static constexpr bool is_method = false;
+};
+
+// The run type of the callback produced by binding `BoundArgs` to `Functor`.
+template <typename Functor, typename... BoundArgs>
+using MakeUnboundRunType = typename MakeFunctionTypeImpl<
+    typename FunctorTraits<Functor>::ReturnType,
+    typename DropTypeListItemImpl<
+        sizeof...(BoundArgs),
+        typename FunctorTraits<Functor>::ArgList>::Type>::Type;
+
+template <typename Functor, typename... BoundArgs>
+class BindState final : public BindStateBase {
+ public:
+  // Methods bound to a weak receiver are skipped once the receiver has been
+  // invalidated.
+  static constexpr bool kIsWeakCall = [] {
+    if constexpr (FunctorTraits<Functor>::is_method &&
+                  sizeof...(BoundArgs) > 0) {
+      return IsWeakPtr<std::tuple_element_t<0, std::tuple<BoundArgs...>>>::value;
+    } else {
+      return false;
+    }
+  }();
+
+  static_assert(!kIsWeakCall ||
+                    std::is_void_v<typename FunctorTraits<Functor>::ReturnType>,
+                "Weak calls can only bind methods that return void.");
+
+  template <typename F, typename... Args>
+  explicit BindState(F&& functor, Args&&... bound_args)
+      : functor_(std::forward<F>(functor)),
+        bound_args_(std::forward<Args>(bound_args)...) {}
+
+  bool IsCancelled() const override {
+    if constexpr (kIsWeakCall) {
+      return !std::get<0>(bound_args_);
+    } else {
+      return false;
+    }
+  }
+
+  template <typename... RunArgs>
+  decltype(auto) Run(RunArgs&&... run_args) {
+    return std::apply(
+        [&](auto&... bound_args) -> decltype(auto) {
+          return RunImpl(std::move(bound_args)...,
+                         std::forward<RunArgs>(run_args)...);
+        },
+        bound_args_);
+  }
+
+ private:
+  template <typename... Args>
+  decltype(auto) RunImpl(Args&&... args) {
+    if constexpr (kIsWeakCall) {
+      RunWeak(std::forward<Args>(args)...);
+    } else if constexpr (IsOnceCallback<Functor>::value) {
+      return std::move(functor_).Run(std::forward<Args>(args)...);
+    } else {
+      return std::invoke(std::move(functor_), std::forward<Args>(args)...);
+    }
+  }
+
+  template <typename Weak, typename... Args>
+  void RunWeak(Weak&& receiver, Args&&... args) {
+    if (!receiver) {
+      return;
+    }
+    std::invoke(functor_, receiver.get(), std::forward<Args>(args)...);
+  }
+
+  Functor functor_;
+  std::tuple<BoundArgs...> bound_args_;
+};
+
+template <typename BindStateType, typename UnboundRunType>
+struct Invoker;
+
+template <typename BindStateType, typename R, typename... UnboundArgs>
+struct Invoker<BindStateType, R(UnboundArgs...)> {
+  static R RunOnce(BindStateBase* base,
+                   PassingType<UnboundArgs>... unbound_args) {
+    auto* state = static_cast<BindStateType*>(base);
+    return state->Run(std::forward<UnboundArgs>(unbound_args)...);
+  }
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_FUNCTIONAL_BIND_INTERNAL_H_
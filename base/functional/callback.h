@@ -0,0 +1,99 @@
+#ifndef BASE_FUNCTIONAL_CALLBACK_H_
+#define BASE_FUNCTIONAL_CALLBACK_H_
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "base/check.h"
+
+namespace base {
+
+namespace internal {
+
+// Arguments are forwarded through the type-erased invoker by value for
+// scalars and by rvalue reference otherwise.
+template <typename T>
+using PassingType = std::conditional_t<std::is_scalar_v<T>, T, T&&>;
+
+// Type-erased storage for a functor and its bound arguments. Each call to
+// `BindOnce` allocates exactly one of these.
+class BindStateBase {
+ public:
+  BindStateBase() = default;
+  BindStateBase(const BindStateBase&) = delete;
+  BindStateBase& operator=(const BindStateBase&) = delete;
+  virtual ~BindStateBase() = default;
+
+  // Returns true if running the callback would be a no-op, e.g. because it is
+  // bound to a method on an invalidated weak pointer.
+  virtual bool IsCancelled() const = 0;
+};
+
+}  // namespace internal
+
+template <typename Signature>
+class OnceCallback;
+
+// A move-only callback that may be run at most once. Running the callback
+// consumes it.
+template <typename R, typename... Args>
+class OnceCallback<R(Args...)> {
+ public:
+  using ResultType = R;
+  using RunType = R(Args...);
+  using PolymorphicInvoke = R (*)(internal::BindStateBase*,
+                                  internal::PassingType<Args>...);
+
+  constexpr OnceCallback() = default;
+  OnceCallback(std::nullptr_t) = delete;
+
+  OnceCallback(std::unique_ptr<internal::BindStateBase> bind_state,
+               PolymorphicInvoke invoke)
+      : bind_state_(std::move(bind_state)), invoke_(invoke) {}
+
+  OnceCallback(const OnceCallback&) = delete;
+  OnceCallback& operator=(const OnceCallback&) = delete;
+
+  OnceCallback(OnceCallback&& other) noexcept
+      : bind_state_(std::move(other.bind_state_)),
+        invoke_(std::exchange(other.invoke_, nullptr)) {}
+
+  OnceCallback& operator=(OnceCallback&& other) noexcept {
+    bind_state_ = std::move(other.bind_state_);
+    invoke_ = std::exchange(other.invoke_, nullptr);
+    return *this;
+  }
+
+  bool is_null() const { return !bind_state_; }
+  explicit operator bool() const { return !is_null(); }
+
+  bool IsCancelled() const {
+    DCHECK(bind_state_);
+    return bind_state_->IsCancelled();
+  }
+
+  void Reset() {
+    bind_state_.reset();
+    invoke_ = nullptr;
+  }
+
+  R Run(Args... args) && {
+    CHECK(bind_state_);
+    // Move the state onto the stack so that the callback is null when the
+    // functor runs, and the bound arguments are released when it returns.
+    OnceCallback cb = std::move(*this);
+    return cb.invoke_(cb.bind_state_.get(), std::forward<Args>(args)...);
+  }
+
+ private:
+  std::unique_ptr<internal::BindStateBase> bind_state_;
+  PolymorphicInvoke invoke_ = nullptr;
+};
+
+using OnceClosure = OnceCallback<void()>;
+
+}  // namespace base
+
+#endif  // BASE_FUNCTIONAL_CALLBACK_H_
@@ -0,0 +1,130 @@
+#ifndef BASE_FUNCTIONAL_INLINE_ONCE_CALLABLE_H_
+#define BASE_FUNCTIONAL_INLINE_ONCE_CALLABLE_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/check.h"
+
+namespace base::internal {
+
+template <typename Signature, size_t kInlineSize>
+class InlineOnceCallable;
+
+// A move-only, type-erased callable that may be run at most once. Callables
+// of up to `kInlineSize` bytes are stored inline, so that wrapping a lambda
+// does not allocate; larger ones are moved to the heap. Unlike
+// `OnceCallback`, this is a value type with no bound-argument support, meant
+// for continuations stored inside other objects.
+template <typename R, typename... Args, size_t kInlineSize>
+class InlineOnceCallable<R(Args...), kInlineSize> {
+  static_assert(kInlineSize >= sizeof(void*));
+
+ public:
+  InlineOnceCallable() = default;
+
+  template <typename F>
+    requires(!std::is_same_v<std::decay_t<F>, InlineOnceCallable> &&
+             std::is_invocable_r_v<R, std::decay_t<F>&&, Args...>)
+  explicit InlineOnceCallable(F&& functor) {
+    using Functor = std::decay_t<F>;
+    if constexpr (kFitsInline<Functor>) {
+      new (storage_) Functor(std::forward<F>(functor));
+      ops_ = &kInlineOps<Functor>;
+    } else {
+      *reinterpret_cast<Functor**>(storage_) =
+          new Functor(std::forward<F>(functor));
+      ops_ = &kHeapOps<Functor>;
+    }
+  }
+
+  InlineOnceCallable(const InlineOnceCallable&) = delete;
+  InlineOnceCallable& operator=(const InlineOnceCallable&) = delete;
+
+  InlineOnceCallable(InlineOnceCallable&& other) noexcept { MoveFrom(other); }
+  InlineOnceCallable& operator=(InlineOnceCallable&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~InlineOnceCallable() { Reset(); }
+
+  bool is_null() const { return !ops_; }
+  explicit operator bool() const { return !is_null(); }
+
+  void Reset() {
+    if (ops_) {
+      std::exchange(ops_, nullptr)->destroy(storage_);
+    }
+  }
+
+  R Run(Args... args) && {
+    CHECK(ops_);
+    // Move the callable onto the stack so that this object is null while it
+    // runs, and its captures are released when it returns.
+    InlineOnceCallable callable = std::move(*this);
+    return callable.ops_->invoke(callable.storage_,
+                                 std::forward<Args>(args)...);
+  }
+
+ private:
+  struct Ops {
+    R (*invoke)(void* storage, Args&&... args);
+    // Move-constructs the callable at `to` from the one at `from`, and
+    // destroys the latter.
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Functor>
+  static constexpr bool kFitsInline =
+      sizeof(Functor) <= kInlineSize &&
+      alignof(Functor) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<Functor>;
+
+  template <typename Functor>
+  static constexpr Ops kInlineOps = {
+      [](void* storage, Args&&... args) -> R {
+        return std::invoke(std::move(*static_cast<Functor*>(storage)),
+                           std::forward<Args>(args)...);
+      },
+      [](void* from, void* to) {
+        Functor* functor = static_cast<Functor*>(from);
+        new (to) Functor(std::move(*functor));
+        functor->~Functor();
+      },
+      [](void* storage) { static_cast<Functor*>(storage)->~Functor(); },
+  };
+
+  template <typename Functor>
+  static constexpr Ops kHeapOps = {
+      [](void* storage, Args&&... args) -> R {
+        return std::invoke(std::move(**static_cast<Functor**>(storage)),
+                           std::forward<Args>(args)...);
+      },
+      [](void* from, void* to) {
+        *static_cast<Functor**>(to) = *static_cast<Functor**>(from);
+      },
+      [](void* storage) { delete *static_cast<Functor**>(storage); },
+  };
+
+  void MoveFrom(InlineOnceCallable& other) {
+    if (other.ops_) {
+      other.ops_->relocate(other.storage_, storage_);
+      ops_ = std::exchange(other.ops_, nullptr);
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+  const Ops* ops_ = nullptr;
+};
+
+}  // namespace base::internal
+
+#endif  // BASE_FUNCTIONAL_INLINE_ONCE_CALLABLE_H_
@@ -0,0 +1,217 @@
+#ifndef BASE_FUTURES_ASYNC_LRU_CACHE_H_
+#define BASE_FUTURES_ASYNC_LRU_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/futures/shared_future.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// A cache of values that are loaded asynchronously, evicting entries older
+// than `ttl`, and then the least recently used entries beyond `max_size`.
+// Loads are single-flight: `Get()` runs the loader only if the key is neither
+// cached nor already loading, and concurrent misses for a key all wait for
+// the one load.
+//
+//   AsyncLruCache<Url, scoped_refptr<Icon>> icons(/*max_size=*/256);
+//
+//   Future<scoped_refptr<Icon>> GetIcon(const Url& url) {
+//     return icons.Get(url, [&] { return FetchIcon(url); });
+//   }
+//
+// Each entry holds the `SharedFuture` of its load, so a loaded value is
+// stored once, and callers receive copies of it; cache `scoped_refptr`s or
+// other cheaply copied handles to large values. An entry costs one
+// allocation for its node and one for its shared state. Must be used on a
+// single sequence.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class AsyncLruCache {
+ public:
+  static_assert(!std::is_void_v<V>, "A cache needs values.");
+
+  struct Stats {
+    // Calls to `Get()` that found a loaded value.
+    int64_t hits = 0;
+    // Calls that joined a load in progress.
+    int64_t joins = 0;
+    // Calls that started a load.
+    int64_t loads = 0;
+  };
+
+  // `ttl` is measured from the start of each entry's load. A load still in
+  // flight never expires, so that it stays the one load for its key however
+  // long it takes.
+  explicit AsyncLruCache(size_t max_size, TimeDelta ttl = TimeDelta::Max())
+      : max_size_(max_size), ttl_(ttl) {
+    CHECK(max_size_ > 0);
+    CHECK(ttl_.is_positive());
+    lru_.prev = lru_.next = &lru_;
+    lru_.load_prev = lru_.load_next = &lru_;
+  }
+
+  AsyncLruCache(const AsyncLruCache&) = delete;
+  AsyncLruCache& operator=(const AsyncLruCache&) = delete;
+  ~AsyncLruCache() = default;
+
+  // Returns a future for the value of `key`. If it is loaded and fresh, the
+  // future is ready. Otherwise it resolves once the load in progress for
+  // `key` does, starting one with `loader`, a callable returning
+  // `Future<V>`, if there is none. If a load's promise is destroyed without
+  // a value, so are those of the futures waiting for it, and the next
+  // `Get()` for the key loads it again. Loads that are evicted or outlived
+  // by the cache still deliver their value to the futures already waiting
+  // for it.
+  template <typename F>
+    requires(std::is_invocable_r_v<Future<V>, F&&>)
+  Future<V> Get(const K& key, F&& loader) {
+    if (auto it = entries_.find(key); it != entries_.end()) {
+      Entry& entry = it->second;
+      if (!entry.load.is_broken() && !IsExpired(entry)) {
+        MoveToFront(entry);
+        if (entry.load.is_ready()) {
+          ++stats_.hits;
+          return MakeReadyFuture(V(entry.load.GetValueSynchronously()));
+        }
+        ++stats_.joins;
+        return Join(entry.load);
+      }
+    }
+    ++stats_.loads;
+    // The loader runs before the entry is created or replaced, so that it may
+    // itself use the cache. The expiry is taken after it, so that entries
+    // inserted by the loader stay in order on the load list.
+    SharedFuture<V> load = std::invoke(std::forward<F>(loader)).Share();
+    const TimeTicks expiry =
+        ttl_.is_max() ? TimeTicks::Max() : TimeTicks::Now() + ttl_;
+    auto [it, inserted] = entries_.try_emplace(key);
+    Entry& entry = it->second;
+    if (inserted) {
+      entry.key = &it->first;
+    } else {
+      Unlink(entry);
+    }
+    entry.load = load;
+    entry.expiry = expiry;
+    Link(entry);
+    Trim(max_size_);
+    if (load.is_ready()) {
+      return MakeReadyFuture(V(load.GetValueSynchronously()));
+    }
+    return Join(std::move(load));
+  }
+
+  // Evicts the expired entries, and then the least recently used ones until
+  // at most `max_size` are left. For callers' memory-pressure handlers.
+  void Trim(size_t max_size) {
+    EvictExpired();
+    while (entries_.size() > max_size) {
+      Evict(*lru_.prev);
+    }
+  }
+
+  void Clear() { Trim(0); }
+
+  size_t size() const { return entries_.size(); }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    SharedFuture<V> load;
+    TimeTicks expiry = TimeTicks::Max();
+    const K* key = nullptr;
+    // Every entry is on the recency list, which is circular, with `lru_` as
+    // its head, most recently used first.
+    Entry* prev = nullptr;
+    Entry* next = nullptr;
+    // And on the load list, which shares its head, most recently started load
+    // first. The TTL is the same for every entry, so this orders entries by
+    // expiry too.
+    Entry* load_prev = nullptr;
+    Entry* load_next = nullptr;
+  };
+
+  // Waits for a load on behalf of one caller. Frames are recycled, so
+  // joining a load does not allocate once the sequence has warmed up.
+  static Future<V> Join(SharedFuture<V> load) { co_return co_await load; }
+
+  bool IsExpired(const Entry& entry) const {
+    return !ttl_.is_max() && entry.load.is_ready() &&
+           TimeTicks::Now() >= entry.expiry;
+  }
+
+  // Evicts the loaded entries that have expired, oldest first, and stops at
+  // the first entry that has not. Loads still in flight are skipped.
+  void EvictExpired() {
+    if (ttl_.is_max()) {
+      return;
+    }
+    const TimeTicks now = TimeTicks::Now();
+    Entry* entry = lru_.load_prev;
+    while (entry != &lru_ && now >= entry->expiry) {
+      Entry* newer = entry->load_prev;
+      if (entry->load.is_ready()) {
+        Evict(*entry);
+      }
+      entry = newer;
+    }
+  }
+
+  void Evict(Entry& entry) {
+    Unlink(entry);
+    entries_.erase(entries_.find(*entry.key));
+  }
+
+  // Links `entry` at the front of both lists.
+  void Link(Entry& entry) {
+    LinkByRecency(entry);
+    entry.load_prev = &lru_;
+    entry.load_next = lru_.load_next;
+    lru_.load_next->load_prev = &entry;
+    lru_.load_next = &entry;
+  }
+
+  void Unlink(Entry& entry) {
+    UnlinkByRecency(entry);
+    entry.load_prev->load_next = entry.load_next;
+    entry.load_next->load_prev = entry.load_prev;
+    entry.load_prev = entry.load_next = nullptr;
+  }
+
+  void LinkByRecency(Entry& entry) {
+    entry.prev = &lru_;
+    entry.next = lru_.next;
+    lru_.next->prev = &entry;
+    lru_.next = &entry;
+  }
+
+  void UnlinkByRecency(Entry& entry) {
+    entry.prev->next = entry.next;
+    entry.next->prev = entry.prev;
+    entry.prev = entry.next = nullptr;
+  }
+
+  void MoveToFront(Entry& entry) {
+    if (lru_.next != &entry) {
+      UnlinkByRecency(entry);
+      LinkByRecency(entry);
+    }
+  }
+
+  const size_t max_size_;
+  const TimeDelta ttl_;
+  std::unordered_map<K, Entry, Hash> entries_;
+  Entry lru_;
+  Stats stats_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_ASYNC_LRU_CACHE_H_
@@ -0,0 +1,168 @@
+// Checks that `AsyncLruCache` runs one load per key however many callers miss
+// at once, and evicts expired entries and then the least recently used ones.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/async_lru_cache.h"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace {
+
+// Loads each key as its length, counting the loads, and optionally keeps them
+// pending until told to finish them.
+class Loader {
+ public:
+  explicit Loader(bool pending = false) : pending_(pending) {}
+
+  Future<int> Load(const std::string& key) {
+    ++num_loads_;
+    if (!pending_) {
+      return MakeReadyFuture(static_cast<int>(key.size()));
+    }
+    promises_.emplace_back();
+    return promises_.back().GetFuture();
+  }
+
+  int num_loads() const { return num_loads_; }
+
+  void Finish(size_t index, int value) {
+    promises_[index].SetValue(value);
+    RunLoop().RunUntilIdle();
+  }
+
+  void Drop(size_t index) {
+    promises_[index] = Promise<int>();
+    RunLoop().RunUntilIdle();
+  }
+
+ private:
+  const bool pending_;
+  int num_loads_ = 0;
+  std::vector<Promise<int>> promises_;
+};
+
+using Cache = AsyncLruCache<std::string, int>;
+
+// Returns the value of `key`, which must be loaded, or load at once.
+int GetNow(Cache& cache, Loader& loader, const std::string& key) {
+  Future<int> future = cache.Get(key, [&] { return loader.Load(key); });
+  CHECK(future.is_ready());
+  return std::move(future).GetValueSynchronously();
+}
+
+void TestConcurrentMissesShareOneLoad() {
+  SingleThreadTaskExecutor executor;
+  Cache cache(/*max_size=*/4);
+  Loader loader(/*pending=*/true);
+  std::vector<int> values;
+  for (int i = 0; i < 3; ++i) {
+    cache.Get("key", [&] { return loader.Load("key"); })
+        .AndThen([&values](int value) { values.push_back(value); });
+  }
+  CHECK(loader.num_loads() == 1);
+  CHECK(cache.stats().loads == 1);
+  CHECK(cache.stats().joins == 2);
+  loader.Finish(0, 42);
+  CHECK(values == std::vector<int>({42, 42, 42}));
+  // The loaded value is now a hit.
+  Future<int> hit = cache.Get("key", [&] { return loader.Load("key"); });
+  CHECK(hit.is_ready());
+  CHECK(std::move(hit).GetValueSynchronously() == 42);
+  CHECK(loader.num_loads() == 1);
+  CHECK(cache.stats().hits == 1);
+}
+
+// A load whose promise breaks breaks its waiters' futures too, and is not
+// kept: the next miss loads again.
+void TestBrokenLoadIsRetried() {
+  SingleThreadTaskExecutor executor;
+  Cache cache(/*max_size=*/4);
+  Loader loader(/*pending=*/true);
+  std::optional<int> value;
+  cache.Get("key", [&] { return loader.Load("key"); })
+      .AndThen([&value](int v) { value = v; });
+  loader.Drop(0);
+  CHECK(!value);
+  cache.Get("key", [&] { return loader.Load("key"); })
+      .AndThen([&value](int v) { value = v; });
+  CHECK(loader.num_loads() == 2);
+  loader.Finish(1, 7);
+  CHECK(value == 7);
+}
+
+void TestEvictsLeastRecentlyUsed() {
+  SingleThreadTaskExecutor executor;
+  Cache cache(/*max_size=*/2);
+  Loader loader;
+  GetNow(cache, loader, "a");
+  GetNow(cache, loader, "bb");
+  // Using "a" makes "bb" the least recently used entry.
+  GetNow(cache, loader, "a");
+  CHECK(loader.num_loads() == 2);
+  GetNow(cache, loader, "ccc");
+  CHECK(cache.size() == 2);
+  CHECK(GetNow(cache, loader, "a") == 1);
+  CHECK(loader.num_loads() == 3);
+  CHECK(GetNow(cache, loader, "bb") == 2);
+  CHECK(loader.num_loads() == 4);
+}
+
+void TestExpiredEntriesAreReloaded() {
+  SingleThreadTaskExecutor executor;
+  Cache cache(/*max_size=*/4, /*ttl=*/Milliseconds(20));
+  Loader loader;
+  GetNow(cache, loader, "a");
+  GetNow(cache, loader, "a");
+  CHECK(loader.num_loads() == 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  GetNow(cache, loader, "a");
+  CHECK(loader.num_loads() == 2);
+  // `Trim()` evicts expired entries even below the size limit.
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  cache.Trim(/*max_size=*/4);
+  CHECK(cache.size() == 0);
+}
+
+// A load in flight stays the one load for its key past its time to live.
+void TestLoadInFlightNeverExpires() {
+  SingleThreadTaskExecutor executor;
+  Cache cache(/*max_size=*/4, /*ttl=*/Milliseconds(20));
+  Loader loader(/*pending=*/true);
+  std::vector<int> values;
+  cache.Get("key", [&] { return loader.Load("key"); })
+      .AndThen([&values](int value) { values.push_back(value); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  cache.Trim(/*max_size=*/4);
+  CHECK(cache.size() == 1);
+  cache.Get("key", [&] { return loader.Load("key"); })
+      .AndThen([&values](int value) { values.push_back(value); });
+  CHECK(loader.num_loads() == 1);
+  loader.Finish(0, 5);
+  CHECK(values == std::vector<int>({5, 5}));
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestConcurrentMissesShareOneLoad();
+  base::TestBrokenLoadIsRetried();
+  base::TestEvictsLeastRecentlyUsed();
+  base::TestExpiredEntriesAreReloaded();
+  base::TestLoadInFlightNeverExpires();
+  return 0;
+}
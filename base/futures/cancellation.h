@@ -0,0 +1,109 @@
+#ifndef BASE_FUTURES_CANCELLATION_H_
+#define BASE_FUTURES_CANCELLATION_H_
+
+#include "base/memory/weak_ptr.h"
+
+namespace base {
+
+class CancellationSource;
+
+// The observable side of a `CancellationSource`. Async operations take a
+// token by reference and register a `CancellationHook` with it to tear down
+// whatever they have in flight, such as a timer in the delayed-task queue.
+//
+// A coroutine that takes a token by reference is destroyed when the token is
+// cancelled, like one whose object has been destroyed, and its pending
+// `co_await` is abandoned:
+//
+//   Future<void> Poll(const CancellationToken& token) {
+//     while (true) {
+//       co_await Delay(Seconds(1), token);
+//       ...
+//     }
+//   }
+//
+// Tokens, like weak pointers, must be used on a single sequence.
+class CancellationToken {
+ public:
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  bool IsCancelled() const { return cancelled_; }
+
+  // Returns a pointer that is invalidated on cancellation, or a null pointer
+  // if the token has already been cancelled.
+  WeakPtr<const CancellationToken> AsWeakPtr() const {
+    if (cancelled_) {
+      return nullptr;
+    }
+    return weak_factory_.GetWeakPtr();
+  }
+
+ private:
+  friend class CancellationSource;
+
+  CancellationToken() = default;
+  ~CancellationToken() = default;
+
+  void Cancel() {
+    cancelled_ = true;
+    weak_factory_.InvalidateWeakPtrs();
+  }
+
+  bool cancelled_ = false;
+  WeakPtrFactory<const CancellationToken> weak_factory_{this};
+};
+
+// Cancels the operations started with its token, either when `Cancel()` is
+// called or when the source is destroyed.
+class CancellationSource {
+ public:
+  CancellationSource() = default;
+  CancellationSource(const CancellationSource&) = delete;
+  CancellationSource& operator=(const CancellationSource&) = delete;
+  ~CancellationSource() { Cancel(); }
+
+  // Runs the hooks registered with the token, each of which is unregistered
+  // before it runs. Cancelling is permanent; later calls do nothing.
+  void Cancel() {
+    if (!token_.IsCancelled()) {
+      token_.Cancel();
+    }
+  }
+
+  bool IsCancelled() const { return token_.IsCancelled(); }
+
+  const CancellationToken& token() const { return token_; }
+
+ private:
+  CancellationToken token_;
+};
+
+// Runs `OnCancelled()` when the token it is registered with is cancelled.
+// Hooks are linked into the token's list, so registering one does not
+// allocate, and a hook unregisters itself when destroyed.
+class CancellationHook : private internal::WeakReferenceObserver {
+ public:
+  CancellationHook() = default;
+
+  // Returns false, without registering, if `token` is already cancelled.
+  bool Register(const CancellationToken& token) {
+    return Observe(token.AsWeakPtr());
+  }
+
+  void Unregister() { StopObserving(); }
+
+  // Called after the hook has been unregistered. May destroy the hook.
+  virtual void OnCancelled() = 0;
+
+ protected:
+  ~CancellationHook() override = default;
+
+ private:
+  // internal::WeakReferenceObserver:
+  void OnWeakReferenceInvalidated() final { OnCancelled(); }
+};
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_CANCELLATION_H_
@@ -0,0 +1,142 @@
+#include "base/futures/coroutine_frame_allocator.h"
+
+#include <new>
+
+#include "base/check.h"
+#include "base/threading/sequence_local_storage_map.h"
+#include "base/threading/sequence_local_storage_slot.h"
+
+namespace base::internal {
+
+namespace {
+
+// Precedes each frame, recording whether its allocation was counted in a
+// sequence's stats, so that its free is counted only if it was. Frames
+// allocated without sequence-local storage are not, but may be freed on a
+// sequence. The header is as large as `operator new`'s alignment, so that
+// frames stay aligned.
+struct FrameHeader {
+  bool counted;
+};
+
+constexpr size_t kFrameHeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+static_assert(sizeof(FrameHeader) <= kFrameHeaderSize);
+
+// Frames of up to `kMaxRecycledFrameSize` bytes are always allocated with the
+// full size of their class, so that any free frame of a class can hold any
+// frame of that class.
+size_t GetSizeClass(size_t size) {
+  return (size - 1) / CoroutineFrameAllocator::kSizeClassGranularity;
+}
+
+size_t GetSizeClassBytes(size_t size_class) {
+  return (size_class + 1) * CoroutineFrameAllocator::kSizeClassGranularity;
+}
+
+}  // namespace
+
+// static
+void* CoroutineFrameAllocator::Allocate(size_t size) {
+  CoroutineFrameAllocator* allocator = GetForCurrentSequence(true);
+  if (allocator) {
+    ++allocator->stats_.allocations;
+    ++allocator->stats_.live_frames;
+  }
+  void* block = AllocateBlock(allocator, size + kFrameHeaderSize);
+  new (block) FrameHeader{allocator != nullptr};
+  return static_cast<char*>(block) + kFrameHeaderSize;
+}
+
+// static
+void CoroutineFrameAllocator::Free(void* frame, size_t size) {
+  void* block = static_cast<char*>(frame) - kFrameHeaderSize;
+  const bool counted = static_cast<FrameHeader*>(block)->counted;
+  CoroutineFrameAllocator* allocator = GetForCurrentSequence(false);
+  if (allocator && counted) {
+    DCHECK(allocator->stats_.live_frames > 0);
+    --allocator->stats_.live_frames;
+  }
+  FreeBlock(allocator, block, size + kFrameHeaderSize);
+}
+
+// static
+void* CoroutineFrameAllocator::AllocateBlock(
+    CoroutineFrameAllocator* allocator,
+    size_t size) {
+  if (size > kMaxRecycledFrameSize) {
+    return ::operator new(size);
+  }
+  const size_t size_class = GetSizeClass(size);
+  if (allocator) {
+    if (FreeFrame* frame = allocator->free_lists_[size_class]) {
+      allocator->free_lists_[size_class] = frame->next;
+      allocator->stats_.retained_bytes -= GetSizeClassBytes(size_class);
+      ++allocator->stats_.free_list_hits;
+      return frame;
+    }
+  }
+  return ::operator new(GetSizeClassBytes(size_class));
+}
+
+// static
+void CoroutineFrameAllocator::FreeBlock(CoroutineFrameAllocator* allocator,
+                                        void* block,
+                                        size_t size) {
+  if (size > kMaxRecycledFrameSize) {
+    ::operator delete(block);
+    return;
+  }
+  const size_t size_class = GetSizeClass(size);
+  const size_t bytes = GetSizeClassBytes(size_class);
+  if (!allocator || allocator->stats_.retained_bytes + bytes >
+                        kMaxRetainedBytes) {
+    ::operator delete(block);
+    return;
+  }
+  allocator->free_lists_[size_class] =
+      new (block) FreeFrame{allocator->free_lists_[size_class]};
+  allocator->stats_.retained_bytes += bytes;
+}
+
+// static
+CoroutineFrameAllocator::Stats
+CoroutineFrameAllocator::GetStatsForCurrentSequence() {
+  CoroutineFrameAllocator* allocator = GetForCurrentSequence(false);
+  return allocator ? allocator->stats_ : Stats();
+}
+
+// static
+void CoroutineFrameAllocator::ReleaseFreeFramesForCurrentSequence() {
+  if (CoroutineFrameAllocator* allocator = GetForCurrentSequence(false)) {
+    allocator->ReleaseFreeFrames();
+  }
+}
+
+CoroutineFrameAllocator::CoroutineFrameAllocator() = default;
+
+CoroutineFrameAllocator::~CoroutineFrameAllocator() {
+  ReleaseFreeFrames();
+}
+
+// static
+CoroutineFrameAllocator* CoroutineFrameAllocator::GetForCurrentSequence(
+    bool create) {
+  if (!SequenceLocalStorageMap::IsSetForCurrentThread()) {
+    return nullptr;
+  }
+  static SequenceLocalStorageSlot<CoroutineFrameAllocator> slot(
+      SequenceLocalStorageSlot<CoroutineFrameAllocator>::Destruction::kLast);
+  return create ? &slot.GetOrCreateValue() : slot.GetValuePointer();
+}
+
+void CoroutineFrameAllocator::ReleaseFreeFrames() {
+  for (FreeFrame*& free_list : free_lists_) {
+    while (FreeFrame* frame = free_list) {
+      free_list = frame->next;
+      ::operator delete(frame);
+    }
+  }
+  stats_.retained_bytes = 0;
+}
+
+}  // namespace base::internal
@@ -0,0 +1,80 @@
+#ifndef BASE_FUTURES_COROUTINE_FRAME_ALLOCATOR_H_
+#define BASE_FUTURES_COROUTINE_FRAME_ALLOCATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace base::internal {
+
+// Allocates the frames of Future-returning coroutines. Freed frames are kept
+// on per-sequence free lists, one per size class, and reused by later
+// coroutines of a similar size, so that short-lived coroutines do not go
+// through the global allocator. Frames larger than `kMaxRecycledFrameSize`,
+// frees that would retain more than `kMaxRetainedBytes`, and frames allocated
+// or freed without sequence-local storage use the global allocator directly.
+// The allocator is destroyed after the sequence's other sequence-local values,
+// so that frames those free while being destroyed are still counted. Each
+// frame carries a small header, included in the sizes above, that records
+// whether its allocation was counted, so that a frame allocated without
+// sequence-local storage and freed on a sequence leaves the counts alone.
+class CoroutineFrameAllocator {
+ public:
+  struct Stats {
+    // Frame allocations on this sequence, of any size, and how many of them
+    // were served from a free list.
+    uint64_t allocations = 0;
+    uint64_t free_list_hits = 0;
+    // Bytes currently held on free lists.
+    size_t retained_bytes = 0;
+    // Frames allocated on this sequence and not yet freed, of any size. A
+    // count that keeps growing means that coroutines are leaking.
+    uint64_t live_frames = 0;
+  };
+
+  static constexpr size_t kSizeClassGranularity = 64;
+  static constexpr size_t kMaxRecycledFrameSize = 2048;
+  static constexpr size_t kMaxRetainedBytes = 1024 * 1024;
+
+  static void* Allocate(size_t size);
+  static void Free(void* frame, size_t size);
+
+  // Returns the current sequence's statistics, which are all zero if no
+  // frame has been allocated on it.
+  static Stats GetStatsForCurrentSequence();
+
+  // Returns the current sequence's free frames to the global allocator, e.g.
+  // under memory pressure.
+  static void ReleaseFreeFramesForCurrentSequence();
+
+  CoroutineFrameAllocator();
+  CoroutineFrameAllocator(const CoroutineFrameAllocator&) = delete;
+  CoroutineFrameAllocator& operator=(const CoroutineFrameAllocator&) = delete;
+  ~CoroutineFrameAllocator();
+
+ private:
+  struct FreeFrame {
+    FreeFrame* next;
+  };
+
+  static constexpr size_t kNumSizeClasses =
+      kMaxRecycledFrameSize / kSizeClassGranularity;
+
+  static CoroutineFrameAllocator* GetForCurrentSequence(bool create);
+
+  // Allocate and free the memory of a frame and its header, through
+  // `allocator`'s free lists if there is one.
+  static void* AllocateBlock(CoroutineFrameAllocator* allocator, size_t size);
+  static void FreeBlock(CoroutineFrameAllocator* allocator,
+                        void* block,
+                        size_t size);
+
+  void ReleaseFreeFrames();
+
+  std::array<FreeFrame*, kNumSizeClasses> free_lists_{};
+  Stats stats_;
+};
+
+}  // namespace base::internal
+
+#endif  // BASE_FUTURES_COROUTINE_FRAME_ALLOCATOR_H_
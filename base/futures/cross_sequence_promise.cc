@@ -0,0 +1,154 @@
+#include "base/futures/cross_sequence_promise.h"
+
+#include "base/functional/bind.h"
+#include "base/location.h"
+#include "base/threading/sequence_local_storage_map.h"
+#include "base/threading/sequence_local_storage_slot.h"
+
+namespace base::internal {
+
+// Registered with the token passed to `SetTeardown()`, and holds the
+// producer's teardown until it runs or the state is deleted.
+class CrossSequenceTeardown final : public CancellationHook {
+ public:
+  CrossSequenceTeardown(CrossSequencePromiseStateBase* state,
+                        OnceClosure teardown)
+      : state_(state), teardown_(std::move(teardown)) {}
+
+  OnceClosure TakeTeardown() { return std::move(teardown_); }
+
+  // CancellationHook:
+  void OnCancelled() override { state_->OnCancelled(); }
+
+ private:
+  CrossSequencePromiseStateBase* const state_;
+  OnceClosure teardown_;
+};
+
+CrossSequencePromiseStateBase::CrossSequencePromiseStateBase()
+    : mailbox_(CrossSequenceMailbox::GetForCurrentSequence()) {}
+
+CrossSequencePromiseStateBase::~CrossSequencePromiseStateBase() = default;
+
+void CrossSequencePromiseStateBase::OnProducerDone() {
+  uint32_t previous =
+      flags_.fetch_or(kProducerDone, std::memory_order_acq_rel);
+  if (!(previous & (kContinuationSet | kFutureDropped))) {
+    // The consumer delivers the value once a continuation is set, or deletes
+    // the state if the future is dropped.
+    return;
+  }
+  if (mailbox_->RunsTasksInCurrentSequence()) {
+    Deliver(/*in_delivery_task=*/false);
+    return;
+  }
+  mailbox_->Push(this);
+}
+
+void CrossSequencePromiseStateBase::OnContinuationSet() {
+  uint32_t previous =
+      flags_.fetch_or(kContinuationSet, std::memory_order_acq_rel);
+  if (previous & kProducerDone) {
+    // The producer finished first and left delivery to the consumer.
+    Deliver(/*in_delivery_task=*/false);
+  }
+}
+
+void CrossSequencePromiseStateBase::OnFutureDropped(bool /*abandoned*/) {
+  OnceClosure teardown;
+  if (teardown_) {
+    teardown = teardown_->TakeTeardown();
+    teardown_.reset();
+  }
+  uint32_t previous =
+      flags_.fetch_or(kFutureDropped, std::memory_order_acq_rel);
+  // If a continuation had been set, a finished producer has queued the state
+  // in the mailbox, which deletes it.
+  if ((previous & (kProducerDone | kContinuationSet)) == kProducerDone) {
+    delete this;
+  }
+  // Stopping the producer may destroy it, and with it the state, so it
+  // comes last.
+  if (teardown) {
+    std::move(teardown).Run();
+  }
+}
+
+void CrossSequencePromiseStateBase::SetTeardown(const CancellationToken& token,
+                                                OnceClosure teardown) {
+  DCHECK(!teardown_);
+  teardown_ =
+      std::make_unique<CrossSequenceTeardown>(this, std::move(teardown));
+  if (!teardown_->Register(token)) {
+    OnCancelled();
+  }
+}
+
+void CrossSequencePromiseStateBase::OnCancelled() {
+  // The consumer no longer sees the future, so from here on the state is
+  // torn down as if it had been dropped.
+  DropPromise();
+  OnFutureDropped(/*abandoned=*/true);
+}
+
+// static
+scoped_refptr<CrossSequenceMailbox>
+CrossSequenceMailbox::GetForCurrentSequence() {
+  const scoped_refptr<SequencedTaskRunner>& task_runner =
+      SequencedTaskRunner::GetCurrentDefault();
+  if (!SequenceLocalStorageMap::IsSetForCurrentThread()) {
+    return MakeRefCounted<CrossSequenceMailbox>(task_runner);
+  }
+  static SequenceLocalStorageSlot<scoped_refptr<CrossSequenceMailbox>> slot;
+  scoped_refptr<CrossSequenceMailbox>& mailbox = slot.GetOrCreateValue();
+  if (!mailbox) {
+    mailbox = MakeRefCounted<CrossSequenceMailbox>(task_runner);
+  }
+  return mailbox;
+}
+
+CrossSequenceMailbox::CrossSequenceMailbox(
+    scoped_refptr<SequencedTaskRunner> task_runner)
+    : task_runner_(std::move(task_runner)) {}
+
+CrossSequenceMailbox::~CrossSequenceMailbox() = default;
+
+void CrossSequenceMailbox::Push(CrossSequencePromiseStateBase* state) {
+  CrossSequencePromiseStateBase* head = head_.load(std::memory_order_relaxed);
+  do {
+    state->next_ = head;
+  } while (!head_.compare_exchange_weak(head, state, std::memory_order_release,
+                                        std::memory_order_relaxed));
+  if (head) {
+    // The delivery task posted for `head` has not taken the list yet.
+    return;
+  }
+  // If the sequence has shut down the states are leaked rather than
+  // destroyed on the wrong sequence.
+  task_runner_->PostTask(
+      FROM_HERE, BindOnce(
+                     [](scoped_refptr<CrossSequenceMailbox> mailbox) {
+                       mailbox->DeliverAll();
+                     },
+                     scoped_refptr<CrossSequenceMailbox>(this)));
+}
+
+void CrossSequenceMailbox::DeliverAll() {
+  CrossSequencePromiseStateBase* state =
+      head_.exchange(nullptr, std::memory_order_acquire);
+  // Reverse the list, so that values are delivered in the order in which
+  // they were pushed.
+  CrossSequencePromiseStateBase* next_to_deliver = nullptr;
+  while (state) {
+    CrossSequencePromiseStateBase* next = state->next_;
+    state->next_ = next_to_deliver;
+    next_to_deliver = state;
+    state = next;
+  }
+  while (next_to_deliver) {
+    state = std::exchange(next_to_deliver, next_to_deliver->next_);
+    state->Deliver(/*in_delivery_task=*/true);
+  }
+}
+
+}  // namespace base::internal
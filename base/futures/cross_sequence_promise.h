@@ -0,0 +1,249 @@
+#ifndef BASE_FUTURES_CROSS_SEQUENCE_PROMISE_H_
+#define BASE_FUTURES_CROSS_SEQUENCE_PROMISE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "base/check.h"
+#include "base/functional/callback.h"
+#include "base/futures/cancellation.h"
+#include "base/futures/future.h"
+#include "base/futures/promise_observer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+namespace internal {
+
+class CrossSequenceMailbox;
+class CrossSequenceTeardown;
+
+// The state of a `CrossSequencePromise`, shared between the producer, which
+// may be on any sequence, and the consumer sequence that created it.
+// Ownership is decided by a single atomic transition on each side: whichever
+// side finishes second delivers the value on the consumer sequence and
+// deletes the state.
+class CrossSequencePromiseStateBase : public PromiseObserver {
+ public:
+  CrossSequencePromiseStateBase(const CrossSequencePromiseStateBase&) = delete;
+  CrossSequencePromiseStateBase& operator=(
+      const CrossSequencePromiseStateBase&) = delete;
+
+  // Called by the producer, on any sequence, once it has set the value or
+  // been destroyed without doing so.
+  void OnProducerDone();
+
+  // May be called by the producer, on any sequence.
+  bool IsFutureDropped() const {
+    return flags_.load(std::memory_order_relaxed) & kFutureDropped;
+  }
+
+  // Arranges for `teardown` to run, on the consumer sequence, if the future
+  // is dropped or `token` is cancelled before the value is delivered. On
+  // cancellation the future's continuation is dropped as well, and the
+  // future is never resolved. `teardown` is meant to stop the producer, for
+  // example by cancelling its timer. Must be called on the consumer sequence
+  // before the future is consumed.
+  void SetTeardown(const CancellationToken& token, OnceClosure teardown);
+
+  // PromiseObserver:
+  void OnContinuationSet() override;
+  void OnFutureDropped(bool abandoned) override;
+
+ protected:
+  CrossSequencePromiseStateBase();
+  ~CrossSequencePromiseStateBase() override;
+
+  // Sets the consumer's promise to the value, if the producer set one and
+  // the promise has not been dropped, and deletes the state. Runs on the
+  // consumer sequence. If `in_delivery_task` is false, continuations are not
+  // run synchronously.
+  virtual void Deliver(bool in_delivery_task) = 0;
+
+  // Destroys the consumer's promise, and with it the future's continuation.
+  virtual void DropPromise() = 0;
+
+ private:
+  friend class CrossSequenceMailbox;
+  friend class CrossSequenceTeardown;
+
+  void OnCancelled();
+
+  // Bits of `flags_`.
+  static constexpr uint32_t kProducerDone = 1 << 0;
+  static constexpr uint32_t kContinuationSet = 1 << 1;
+  static constexpr uint32_t kFutureDropped = 1 << 2;
+
+  std::atomic<uint32_t> flags_{0};
+  const scoped_refptr<CrossSequenceMailbox> mailbox_;
+  // Links states waiting in `mailbox_`.
+  CrossSequencePromiseStateBase* next_ = nullptr;
+  // Accessed only on the consumer sequence. Set by `SetTeardown()`.
+  std::unique_ptr<CrossSequenceTeardown> teardown_;
+};
+
+template <typename T>
+class CrossSequencePromiseState final : public CrossSequencePromiseStateBase {
+ public:
+  CrossSequencePromiseState() { FutureAccess::SetObserver(promise_, this); }
+
+  Future<T> GetFuture() { return promise_.GetFuture(); }
+
+  // Called by the producer. Publishing the value is ordered by
+  // `OnProducerDone()`.
+  void SetValue(T value) { value_.emplace(std::move(value)); }
+
+ private:
+  ~CrossSequencePromiseState() override = default;
+
+  void Deliver(bool in_delivery_task) override {
+    if (value_ && !promise_dropped_) {
+      if (in_delivery_task) {
+        promise_.SetValueWithSideEffects(std::move(*value_));
+      } else {
+        promise_.SetValue(std::move(*value_));
+      }
+    }
+    delete this;
+  }
+
+  void DropPromise() override {
+    promise_dropped_ = true;
+    Promise<T> dropped_promise = std::move(promise_);
+  }
+
+  // Accessed only on the consumer sequence.
+  Promise<T> promise_;
+  bool promise_dropped_ = false;
+  // Written by the producer before `OnProducerDone()`, and read by the
+  // consumer after observing it.
+  std::optional<T> value_;
+};
+
+// Collects the cross-sequence promises resolved toward one sequence, and
+// delivers all that arrive before it runs in a single task. Pushing is
+// lock-free; the delivery task takes the whole list with one exchange.
+class CrossSequenceMailbox : public RefCountedThreadSafe<CrossSequenceMailbox> {
+ public:
+  // Returns the mailbox of the current sequence, which must have a default
+  // task runner.
+  static scoped_refptr<CrossSequenceMailbox> GetForCurrentSequence();
+
+  explicit CrossSequenceMailbox(scoped_refptr<SequencedTaskRunner> task_runner);
+
+  bool RunsTasksInCurrentSequence() const {
+    return task_runner_->RunsTasksInCurrentSequence();
+  }
+
+  // Queues `state` for delivery, posting a delivery task unless one is
+  // already pending. May be called from any sequence.
+  void Push(CrossSequencePromiseStateBase* state);
+
+ private:
+  friend class RefCountedThreadSafe<CrossSequenceMailbox>;
+
+  ~CrossSequenceMailbox();
+
+  void DeliverAll();
+
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+  // The most recently pushed state; each links to the one pushed before it.
+  std::atomic<CrossSequencePromiseStateBase*> head_{nullptr};
+};
+
+}  // namespace internal
+
+// A promise that may be resolved from any sequence, for a future consumed on
+// the sequence that created it. Unlike `MakeFuture`, resolving it does not
+// post a task of its own: setting the value is a single atomic transition,
+// after which the value is delivered either when a continuation is attached
+// on the consumer sequence, or, if one already was, by a task shared with all
+// the other promises resolved toward that sequence in the meantime.
+//
+//   CrossSequencePromise<Result> promise;
+//   Future<Result> future = promise.GetFuture();
+//   worker_pool->PostTask(FROM_HERE, BindOnce(
+//       [](CrossSequencePromise<Result> promise) {
+//         promise.SetValue(ComputeResult());
+//       },
+//       std::move(promise)));
+//
+// A promise destroyed without a value breaks its future, like `Promise<T>`:
+// once that is delivered to the consumer sequence, a coroutine suspended on the
+// future is destroyed, unless it awaits it through `AwaitOptional()`, and a
+// continuation attached with `AndThen` is destroyed without running.
+template <typename T>
+class CrossSequencePromise {
+ public:
+  using Storage = internal::FutureStorageType<T>;
+
+  CrossSequencePromise()
+      : state_(new internal::CrossSequencePromiseState<Storage>()) {}
+
+  CrossSequencePromise(CrossSequencePromise&& other)
+      : state_(std::exchange(other.state_, nullptr)) {}
+  CrossSequencePromise& operator=(CrossSequencePromise&& other) {
+    if (this != &other) {
+      Reset();
+      state_ = std::exchange(other.state_, nullptr);
+    }
+    return *this;
+  }
+
+  ~CrossSequencePromise() { Reset(); }
+
+  // Returns the future for this promise. Must be called once, on the
+  // sequence that created the promise, before the promise is handed to
+  // another sequence.
+  Future<T> GetFuture() {
+    CHECK(state_);
+    return Future<T>(state_->GetFuture());
+  }
+
+  // Sets the value of the future. May be called from any sequence, at most
+  // once.
+  void SetValue(Storage value)
+    requires(!std::is_void_v<T>)
+  {
+    CHECK(state_);
+    state_->SetValue(std::move(value));
+    Reset();
+  }
+
+  void SetValue()
+    requires(std::is_void_v<T>)
+  {
+    CHECK(state_);
+    state_->SetValue(VoidFutureValue());
+    Reset();
+  }
+
+  // Returns true once the future has been dropped, abandoned or cancelled on
+  // the consumer sequence, so that the producer may skip computing the
+  // value. May be called from any sequence; the answer may be stale, but
+  // only by missing a drop that is still in flight.
+  bool IsAbandoned() const {
+    CHECK(state_);
+    return state_->IsFutureDropped();
+  }
+
+ private:
+  friend struct internal::CrossSequencePromiseAccess;
+
+  void Reset() {
+    if (state_) {
+      std::exchange(state_, nullptr)->OnProducerDone();
+    }
+  }
+
+  internal::CrossSequencePromiseState<Storage>* state_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_CROSS_SEQUENCE_PROMISE_H_
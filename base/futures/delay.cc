@@ -0,0 +1,67 @@
+#include "base/futures/delay.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/futures/promise_observer.h"
+#include "base/task/timer_wheel.h"
+
+namespace base {
+
+namespace {
+
+// The promise of a `Delay` future and its timer on the sequence's wheel.
+// The state owns itself. It is destroyed once the timer fires, or, cancelling
+// the timer, when the consumer drops the future or the token is cancelled.
+class DelayState final : public TimerWheel::Timer,
+                         public internal::PromiseObserver,
+                         public CancellationHook {
+ public:
+  DelayState() { internal::FutureAccess::SetObserver(promise_, this); }
+
+  Future<void> GetFuture() { return promise_.GetFuture(); }
+
+  // internal::PromiseObserver:
+  void OnFutureDropped(bool /*abandoned*/) override { delete this; }
+
+  // CancellationHook:
+  void OnCancelled() override { delete this; }
+
+ private:
+  // TimerWheel::Timer:
+  void OnTimerFired() override {
+    Promise<VoidFutureValue> promise = std::move(promise_);
+    delete this;
+    promise.SetValueWithSideEffects(VoidFutureValue());
+  }
+
+  void OnTimerWheelDestroyed() override { delete this; }
+
+  Promise<VoidFutureValue> promise_;
+};
+
+Future<void> DelayImpl(TimeDelta delay, const CancellationToken* token) {
+  if (!delay.is_positive()) {
+    return MakeReadyFuture();
+  }
+  auto state = std::make_unique<DelayState>();
+  Future<void> future = state->GetFuture();
+  if (token && !state->Register(*token)) {
+    // Already cancelled: the future is never resolved.
+    return future;
+  }
+  TimerWheel::GetForCurrentSequence().Schedule(*state.release(), delay);
+  return future;
+}
+
+}  // namespace
+
+Future<void> Delay(TimeDelta delay) {
+  return DelayImpl(delay, /*token=*/nullptr);
+}
+
+Future<void> Delay(TimeDelta delay, const CancellationToken& token) {
+  return DelayImpl(delay, &token);
+}
+
+}  // namespace base
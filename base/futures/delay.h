@@ -0,0 +1,23 @@
+#ifndef BASE_FUTURES_DELAY_H_
+#define BASE_FUTURES_DELAY_H_
+
+#include "base/futures/cancellation.h"
+#include "base/futures/future.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Returns a future that is resolved on the current sequence once `delay` has
+// elapsed, rounded up to the slack of the sequence's `TimerWheel`. If the
+// future is dropped or abandoned before then, its timer is removed from the
+// wheel rather than left to fire for nothing. Neither costs more than
+// constant time, so a sequence can keep very many delays pending.
+Future<void> Delay(TimeDelta delay);
+
+// As above, but cancelling `token` also removes the timer, and the future is
+// never resolved.
+Future<void> Delay(TimeDelta delay, const CancellationToken& token);
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_DELAY_H_
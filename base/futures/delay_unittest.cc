@@ -0,0 +1,64 @@
+// Checks that `Delay` resolves once its delay has elapsed, and that dropping
+// its future or cancelling its token takes its timer off the wheel.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/delay.h"
+
+#include "base/check.h"
+#include "base/futures/cancellation.h"
+#include "base/futures/future.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/task/timer_wheel.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace {
+
+void TestResolvesAfterDelay() {
+  SingleThreadTaskExecutor executor;
+  RunLoop run_loop;
+  TimeTicks resolved_at;
+  const TimeTicks start = TimeTicks::Now();
+  Delay(Milliseconds(10)).AndThen([&] {
+    resolved_at = TimeTicks::Now();
+    run_loop.Quit();
+  });
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 1);
+  run_loop.Run();
+  CHECK(resolved_at - start >= Milliseconds(10));
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 0);
+}
+
+void TestDroppedFutureCancelsTimer() {
+  SingleThreadTaskExecutor executor;
+  {
+    Future<void> delay = Delay(Seconds(60));
+    CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 1);
+  }
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 0);
+}
+
+void TestCancelledTokenCancelsTimer() {
+  SingleThreadTaskExecutor executor;
+  CancellationSource source;
+  bool resolved = false;
+  Delay(Seconds(60), source.token()).AndThen([&resolved] { resolved = true; });
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 1);
+  source.Cancel();
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 0);
+  RunLoop().RunUntilIdle();
+  CHECK(!resolved);
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestResolvesAfterDelay();
+  base::TestDroppedFutureCancelsTimer();
+  base::TestCancelledTokenCancelsTimer();
+  return 0;
+}
@@ -0,0 +1,198 @@
+#ifndef BASE_FUTURES_FOR_EACH_ASYNC_H_
+#define BASE_FUTURES_FOR_EACH_ASYNC_H_
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+
+namespace base {
+
+namespace internal {
+
+// The state of a `ForEachAsync`: the input and the position reached in it,
+// the results buffer, and the promise for the results. Each pending future's
+// continuation holds a reference, and starts the next element when it runs.
+template <typename Range, typename F, typename R>
+class ForEachAsyncState : public RefCounted<ForEachAsyncState<Range, F, R>> {
+ public:
+  static constexpr bool kIsVoid = std::is_same_v<R, VoidFutureValue>;
+
+  using ResultType =
+      std::conditional_t<kIsVoid, VoidFutureValue, std::vector<R>>;
+
+  ForEachAsyncState(Promise<ResultType> promise, Range range, F fn)
+      : promise_(std::move(promise)),
+        range_(std::move(range)),
+        fn_(std::move(fn)),
+        next_(std::ranges::begin(range_)) {
+    if constexpr (!kIsVoid && std::ranges::sized_range<Range>) {
+      results_.reserve(std::ranges::size(range_));
+    }
+  }
+
+  // Must be called once, after construction. Futures never run their
+  // continuations from within `AndThen`, so none of the started elements
+  // finishes before this returns.
+  void Start(size_t max_in_flight) {
+    while (in_flight_ < max_in_flight && !input_broken_ && StartNext()) {
+    }
+    if (in_flight_ == 0) {
+      // The range is empty.
+      Finish();
+    }
+  }
+
+ private:
+  friend class RefCounted<ForEachAsyncState>;
+
+  static constexpr bool kStoresValuesDirectly =
+      std::is_default_constructible_v<R>;
+
+  // Held by the continuation of each pending future. If the continuation is
+  // destroyed without running, because the future's promise was destroyed
+  // without a value, marks the state as broken.
+  class ResultGuard {
+   public:
+    explicit ResultGuard(ForEachAsyncState* state) : state_(state) {}
+    ResultGuard(ResultGuard&&) = default;
+    ResultGuard& operator=(ResultGuard&&) = delete;
+    ~ResultGuard() {
+      if (state_) {
+        state_->input_broken_ = true;
+      }
+    }
+
+    scoped_refptr<ForEachAsyncState> Release() { return std::move(state_); }
+
+   private:
+    scoped_refptr<ForEachAsyncState> state_;
+  };
+
+  ~ForEachAsyncState() = default;
+
+  // Calls `fn_` on the next element, if there is one.
+  bool StartNext() {
+    if (next_ == std::ranges::end(range_)) {
+      return false;
+    }
+    const size_t index = num_started_++;
+    if constexpr (!kIsVoid) {
+      results_.emplace_back();
+    }
+    Future<R> future = std::invoke(fn_, *next_);
+    ++next_;
+    ++in_flight_;
+    std::move(future).AndThen(
+        [guard = ResultGuard(this), index](R value) mutable {
+          guard.Release()->OnResult(index, std::move(value));
+        });
+    return true;
+  }
+
+  void OnResult(size_t index, R value) {
+    if constexpr (!kIsVoid) {
+      results_[index] = std::move(value);
+    }
+    --in_flight_;
+    // Nothing more is started once the results are no longer wanted, or can
+    // no longer be delivered, and the state goes away with the last pending
+    // future.
+    if (promise_.IsAbandoned() || input_broken_ || StartNext() ||
+        in_flight_ > 0) {
+      return;
+    }
+    Finish();
+  }
+
+  void Finish() {
+    if constexpr (kIsVoid) {
+      promise_.SetValueWithSideEffects(VoidFutureValue());
+    } else if constexpr (kStoresValuesDirectly) {
+      promise_.SetValueWithSideEffects(std::move(results_));
+    } else {
+      ResultType values;
+      values.reserve(results_.size());
+      for (std::optional<R>& result : results_) {
+        values.push_back(std::move(*result));
+      }
+      promise_.SetValueWithSideEffects(std::move(values));
+    }
+  }
+
+  Promise<ResultType> promise_;
+  Range range_;
+  F fn_;
+  std::ranges::iterator_t<Range> next_;
+  [[no_unique_address]] std::conditional_t<
+      kIsVoid,
+      std::monostate,
+      std::conditional_t<kStoresValuesDirectly,
+                         std::vector<R>,
+                         std::vector<std::optional<R>>>>
+      results_;
+  size_t num_started_ = 0;
+  size_t in_flight_ = 0;
+  // Set once the promise of one of the futures is destroyed without a value.
+  bool input_broken_ = false;
+};
+
+template <typename Range, typename F>
+using ForEachAsyncFutureType =
+    std::invoke_result_t<F&, std::ranges::range_reference_t<Range&>>;
+
+}  // namespace internal
+
+// Calls `fn` on each element of `range` in order, where `fn` returns a
+// `Future`, keeping at most `max_in_flight` of those futures pending at a
+// time: the first `max_in_flight` elements are started at once, and each
+// future that resolves starts the next element. Returns a future for all of
+// their values in the order of `range`, or a `Future<void>` if `fn` returns
+// `Future<void>`.
+//
+//   Future<std::vector<Response>> responses = ForEachAsync(
+//       std::move(requests), /*max_in_flight=*/16,
+//       [&](const Request& request) { return backend->Send(request); });
+//
+// `range` is moved or copied into the shared state, which is the only
+// allocation besides the results buffer; the continuations of the pending
+// futures are stored inline. If the returned future is destroyed or
+// abandoned, no further elements are started. If a promise of one of the
+// futures is destroyed without a value, neither are any further elements,
+// and the returned future's promise is destroyed once those pending have
+// finished.
+template <typename Range, typename F>
+  requires(std::ranges::input_range<std::decay_t<Range>> &&
+           internal::IsFuture<
+               internal::ForEachAsyncFutureType<std::decay_t<Range>, F>>)
+auto ForEachAsync(Range&& range, size_t max_in_flight, F fn) {
+  using InputRange = std::decay_t<Range>;
+  using ValueType = typename internal::ForEachAsyncFutureType<InputRange,
+                                                              F>::ValueType;
+  using State = internal::ForEachAsyncState<
+      InputRange, F, internal::FutureStorageType<ValueType>>;
+  using ResultType = typename State::ResultType;
+  using ReturnType = std::conditional_t<State::kIsVoid, Future<void>,
+                                        Future<ResultType>>;
+  CHECK(max_in_flight > 0);
+  Promise<ResultType> promise;
+  ReturnType future = promise.GetFuture();
+  scoped_refptr<State> state = MakeRefCounted<State>(
+      std::move(promise), std::forward<Range>(range), std::move(fn));
+  state->Start(max_in_flight);
+  return future;
+}
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_FOR_EACH_ASYNC_H_
@@ -0,0 +1,140 @@
+// Checks that `ForEachAsync` keeps at most `max_in_flight` futures pending,
+// and resolves with their values in the order of its input.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/for_each_async.h"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+
+namespace base {
+namespace {
+
+// Holds each request's promise until told to answer it.
+class Backend {
+ public:
+  Future<int> Send(int request) {
+    requests_.push_back(request);
+    promises_.emplace_back();
+    return promises_.back().GetFuture();
+  }
+
+  size_t num_sent() const { return promises_.size(); }
+
+  // Answers request `index` with its request, doubled.
+  void Answer(size_t index) {
+    promises_[index].SetValue(requests_[index] * 2);
+    RunLoop().RunUntilIdle();
+  }
+
+  // Destroys request `index`'s promise without answering it.
+  void Drop(size_t index) {
+    promises_[index] = Promise<int>();
+    RunLoop().RunUntilIdle();
+  }
+
+ private:
+  std::vector<int> requests_;
+  std::vector<Promise<int>> promises_;
+};
+
+// A result that has no default constructor.
+class Reply {
+ public:
+  explicit Reply(int value) : value_(value) {}
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+void TestKeepsInputOrderWithBoundedConcurrency() {
+  SingleThreadTaskExecutor executor;
+  Backend backend;
+  std::optional<std::vector<int>> result;
+  ForEachAsync(std::vector<int>{1, 2, 3, 4, 5}, /*max_in_flight=*/2,
+               [&backend](int request) { return backend.Send(request); })
+      .AndThen([&result](std::vector<int> values) {
+        result = std::move(values);
+      });
+  CHECK(backend.num_sent() == 2);
+  // Each answer starts the next element, whichever request it was for.
+  backend.Answer(1);
+  CHECK(backend.num_sent() == 3);
+  backend.Answer(2);
+  backend.Answer(0);
+  CHECK(backend.num_sent() == 5);
+  backend.Answer(4);
+  CHECK(!result);
+  backend.Answer(3);
+  CHECK(result == std::vector<int>({2, 4, 6, 8, 10}));
+}
+
+void TestNonDefaultConstructibleResults() {
+  SingleThreadTaskExecutor executor;
+  Backend backend;
+  std::optional<std::vector<Reply>> result;
+  ForEachAsync(std::vector<int>{1, 2, 3}, /*max_in_flight=*/3,
+               [&backend](int request) {
+                 return backend.Send(request).Transform(
+                     [](int value) { return Reply(value); });
+               })
+      .AndThen([&result](std::vector<Reply> values) {
+        result = std::move(values);
+      });
+  backend.Answer(2);
+  backend.Answer(0);
+  backend.Answer(1);
+  CHECK(result && result->size() == 3);
+  CHECK((*result)[0].value() == 2);
+  CHECK((*result)[1].value() == 4);
+  CHECK((*result)[2].value() == 6);
+}
+
+void TestEmptyInputResolvesAtOnce() {
+  SingleThreadTaskExecutor executor;
+  Backend backend;
+  std::optional<std::vector<int>> result;
+  ForEachAsync(std::vector<int>(), /*max_in_flight=*/2,
+               [&backend](int request) { return backend.Send(request); })
+      .AndThen([&result](std::vector<int> values) {
+        result = std::move(values);
+      });
+  RunLoop().RunUntilIdle();
+  CHECK(result && result->empty());
+}
+
+// Once a request's promise breaks, no further element is started, and the
+// result never arrives.
+void TestBrokenInputStopsStartingElements() {
+  SingleThreadTaskExecutor executor;
+  Backend backend;
+  bool resolved = false;
+  ForEachAsync(std::vector<int>{1, 2, 3, 4}, /*max_in_flight=*/2,
+               [&backend](int request) { return backend.Send(request); })
+      .AndThen([&resolved](std::vector<int>) { resolved = true; });
+  backend.Drop(0);
+  backend.Answer(1);
+  CHECK(backend.num_sent() == 2);
+  CHECK(!resolved);
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestKeepsInputOrderWithBoundedConcurrency();
+  base::TestNonDefaultConstructibleResults();
+  base::TestEmptyInputResolvesAtOnce();
+  base::TestBrokenInputStopsStartingElements();
+  return 0;
+}
@@ -0,0 +1,908 @@
+#ifndef BASE_FUTURES_FUTURE_H_
+#define BASE_FUTURES_FUTURE_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/functional/inline_once_callable.h"
+#include "base/futures/future_coroutine_internal.h"
+#include "base/futures/microtask_queue.h"
+#include "base/futures/promise_observer.h"
+#include "base/location.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+template <typename T>
+class SharedFuture;
+
+// The underlying value type of `Future<void>` and `Promise<void>`.
+struct VoidFutureValue {};
+
+template <>
+class Future<void>;
+
+template <>
+class Promise<void>;
+
+template <typename T>
+class CrossSequencePromise;
+
+class CancellationToken;
+
+namespace internal {
+
+struct FutureAccess;
+
+template <typename T>
+struct FutureStorageTypeImpl {
+  using Type = T;
+};
+
+template <>
+struct FutureStorageTypeImpl<void> {
+  using Type = VoidFutureValue;
+};
+
+// The type actually held by a `Future<T>`: `T`, or `VoidFutureValue` for
+// `void`.
+template <typename T>
+using FutureStorageType = typename FutureStorageTypeImpl<T>::Type;
+
+// Continuations attached to a future are stored inline up to this size.
+inline constexpr size_t kFutureContinuationInlineSize = 48;
+
+template <typename T>
+using FutureContinuation =
+    InlineOnceCallable<void(T), kFutureContinuationInlineSize>;
+
+// Callables accepted by `Future<T>::AndThen` and `Transform`: invocable as an
+// rvalue with the value, either by value or by lvalue reference.
+template <typename F, typename T>
+concept FutureCallable = std::is_invocable_v<std::decay_t<F>, T> ||
+                         std::is_invocable_v<std::decay_t<F>, T&>;
+
+template <typename F, typename T>
+decltype(auto) InvokeWithFutureValue(F&& callable, T& value) {
+  if constexpr (std::is_invocable_v<std::decay_t<F>, T>) {
+    return std::invoke(std::forward<F>(callable), std::move(value));
+  } else {
+    return std::invoke(std::forward<F>(callable), value);
+  }
+}
+
+template <typename F, typename T>
+using FutureCallableResult = decltype(InvokeWithFutureValue(
+    std::declval<std::decay_t<F>>(), std::declval<T&>()));
+
+template <typename R>
+struct IsFutureImpl : std::false_type {};
+
+template <typename U>
+struct IsFutureImpl<Future<U>> : std::true_type {};
+
+template <typename R>
+concept IsFuture = IsFutureImpl<R>::value;
+
+}  // namespace internal
+
+// ===========
+//  Future<T>
+// ===========
+
+// A move-only handle to a value that will become available later on the
+// current sequence. A future and its promise form an entangled pair: each
+// points to the other for as long as both are alive and the value has not
+// been delivered, so neither performs any dynamic allocation.
+template <typename T>
+class Future {
+ public:
+  using ValueType = T;
+
+  // Default-constructed futures are inactive.
+  Future() = default;
+
+  // Futures are non-copyable.
+  Future(const Future&) = delete;
+  Future& operator=(const Future&) = delete;
+
+  // Futures are movable. Moved-from futures are inactive.
+  Future(Future&& other) noexcept { MoveFrom(other); }
+  Future& operator=(Future&& other) noexcept {
+    if (this != &other) {
+      Disentangle();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~Future() { Disentangle(); }
+
+  // Returns true if the future currently holds a value.
+  bool is_ready() const { return value_.has_value(); }
+
+  // Returns the value of the future. It is an error to call this method when
+  // the future does not currently hold a value.
+  T GetValueSynchronously() && {
+    CHECK(is_ready());
+    active_ = false;
+    T value = std::move(*value_);
+    value_.reset();
+    return value;
+  }
+
+  // Attaches a callback that will be executed when the future value is
+  // available. The callback will be executed on the caller's task runner
+  // and will always execute in a future turn. If the value becomes available
+  // during a task on that sequence, the callback runs as soon as the task
+  // completes, ahead of other queued tasks. Once called, the future will
+  // become inactive. It is an error to call `AndThen` on an inactive future.
+  void AndThen(OnceCallback<void(T)> callback) && {
+    std::move(*this).AndThen([callback = std::move(callback)](T value) mutable {
+      std::move(callback).Run(std::move(value));
+    });
+  }
+
+  // Attaches a callback that accepts a reference to the future value.
+  void AndThen(OnceCallback<void(T&)> callback) && {
+    std::move(*this).AndThen([callback = std::move(callback)](T& value) mutable {
+      std::move(callback).Run(value);
+    });
+  }
+
+  void AndThen(OnceCallback<void(const T&)> callback) && {
+    std::move(*this).AndThen(
+        [callback = std::move(callback)](const T& value) mutable {
+          std::move(callback).Run(value);
+        });
+  }
+
+  // Attaches a transforming callback that will be executed when the future
+  // value is available. Returns a future for the transformed value. If the
+  // callback returns an inactive future, the returned future never resolves.
+  template <typename U>
+  Future<U> AndThen(OnceCallback<Future<U>(T)> callback) && {
+    return std::move(*this).AndThen(
+        [callback = std::move(callback)](T value) mutable {
+          return std::move(callback).Run(std::move(value));
+        });
+  }
+
+  // Attaches a transforming callback that will be executed when the future
+  // value is available. Returns a future for the transformed value.
+  template <typename U>
+  Future<U> Transform(OnceCallback<U(T)> callback) && {
+    return std::move(*this).Transform(
+        [callback = std::move(callback)](T value) mutable {
+          return std::move(callback).Run(std::move(value));
+        });
+  }
+
+  // Overloads of the above that accept any move-only callable, such as a
+  // lambda, taking the value by value or by reference. Callables of up to
+  // `internal::kFutureContinuationInlineSize` bytes are stored without
+  // allocating, so unlike `BindOnce` they add no allocation to the
+  // continuation.
+  template <typename F>
+    requires(internal::FutureCallable<F, T> &&
+             std::is_void_v<internal::FutureCallableResult<F, T>>)
+  void AndThen(F&& callback) && {
+    if constexpr (std::is_invocable_v<std::decay_t<F>, T>) {
+      std::move(*this).SetContinuation(
+          internal::FutureContinuation<T>(std::forward<F>(callback)));
+    } else {
+      std::move(*this).SetContinuation(internal::FutureContinuation<T>(
+          [callback = std::forward<F>(callback)](T value) mutable {
+            std::invoke(std::move(callback), value);
+          }));
+    }
+  }
+
+  template <typename F>
+    requires(internal::FutureCallable<F, T> &&
+             internal::IsFuture<internal::FutureCallableResult<F, T>>)
+  auto AndThen(F&& callback) && {
+    using U = typename internal::FutureCallableResult<F, T>::ValueType;
+    using Storage = internal::FutureStorageType<U>;
+    Promise<Storage> promise;
+    Future<U> future(promise.GetFuture());
+    std::move(*this).AndThen([callback = std::forward<F>(callback),
+                              promise = std::move(promise)](T value) mutable {
+      Future<Storage> next =
+          internal::InvokeWithFutureValue(std::move(callback), value);
+      if (!next.active_) {
+        // The callback declined to continue, e.g. because its receiver has
+        // been destroyed. The returned future will never resolve.
+        return;
+      }
+      std::move(next).AndThen(
+          [promise = std::move(promise)](Storage value) mutable {
+            promise.SetValueWithSideEffects(std::move(value));
+          });
+    });
+    return future;
+  }
+
+  template <typename F>
+    requires(internal::FutureCallable<F, T>)
+  auto Transform(F&& callback) && {
+    using U = std::decay_t<internal::FutureCallableResult<F, T>>;
+    using Storage = internal::FutureStorageType<U>;
+    Promise<Storage> promise;
+    Future<U> future(promise.GetFuture());
+    std::move(*this).AndThen([callback = std::forward<F>(callback),
+                              promise = std::move(promise)](T value) mutable {
+      if constexpr (std::is_void_v<U>) {
+        internal::InvokeWithFutureValue(std::move(callback), value);
+        promise.SetValueWithSideEffects(VoidFutureValue());
+      } else {
+        promise.SetValueWithSideEffects(
+            internal::InvokeWithFutureValue(std::move(callback), value));
+      }
+    });
+    return future;
+  }
+
+  // Converts the future into a `SharedFuture`, which any number of consumers
+  // may await or attach callbacks to, each receiving a reference to the one
+  // stored value. The future becomes inactive. Defined in
+  // "base/futures/shared_future.h".
+  SharedFuture<T> Share() &&;
+
+ protected:
+  friend class Promise<T>;
+  template <typename U>
+  friend class Future;
+  template <typename U, internal::FutureAwaitMode kMode>
+  friend class internal::FutureAwaiter;
+  friend struct internal::FutureAccess;
+  template <typename U>
+  friend Future<U> MakeReadyFuture(U value);
+
+  explicit Future(Promise<T>* promise) : promise_(promise), active_(true) {
+    promise_->future_ = this;
+  }
+
+  Future(std::in_place_t, T value) : value_(std::move(value)), active_(true) {}
+
+ private:
+  void SetContinuation(internal::FutureContinuation<T> continuation) && {
+    Watch(std::move(continuation));
+    Detach();
+  }
+
+  // Hands `continuation` to the promise, but unlike `AndThen` stays entangled
+  // with it until the value is delivered. Destroying a watching future
+  // withdraws the continuation, which lets combinators drop the inputs they
+  // no longer need.
+  void Watch(internal::FutureContinuation<T> continuation) {
+    CHECK(active_);
+    active_ = false;
+    if (value_) {
+      T value = std::move(*value_);
+      value_.reset();
+      internal::PostContinuation(
+          SequencedTaskRunner::GetCurrentDefault(),
+          [continuation = std::move(continuation),
+           value = std::move(value)]() mutable {
+            std::move(continuation).Run(std::move(value));
+          });
+      return;
+    }
+    if (promise_) {
+      promise_->SetContinuation(std::move(continuation));
+    }
+    // Otherwise the promise was destroyed without a value, and the
+    // continuation can never run.
+  }
+
+  // Like `Watch`, but resumes the suspended coroutine `waiter` with the
+  // value instead of running a callback.
+  void AwaitWith(internal::FutureWaiter<T>* waiter) {
+    CHECK(active_);
+    active_ = false;
+    if (value_) {
+      waiter->value.emplace(std::move(*value_));
+      value_.reset();
+      internal::PostContinuation(SequencedTaskRunner::GetCurrentDefault(),
+                                 [waiter] { waiter->resume(waiter); });
+      return;
+    }
+    if (promise_) {
+      promise_->SetWaiter(waiter);
+    }
+  }
+
+  // Drops the future and tells its promise that nobody will ever listen for
+  // the value. A coroutine suspended on producing it is destroyed.
+  void Abandon() {
+    active_ = false;
+    value_.reset();
+    if (Promise<T>* promise = std::exchange(promise_, nullptr)) {
+      promise->DropFuture(/*abandoned=*/true);
+    }
+  }
+
+  void MoveFrom(Future& other) {
+    promise_ = std::exchange(other.promise_, nullptr);
+    value_ = std::move(other.value_);
+    other.value_.reset();
+    active_ = std::exchange(other.active_, false);
+    if (promise_) {
+      promise_->future_ = this;
+    }
+  }
+
+  // Stops tracking the promise, leaving any continuation with it.
+  void Detach() {
+    if (promise_) {
+      promise_->future_ = nullptr;
+      promise_ = nullptr;
+    }
+  }
+
+  // Stops tracking the promise, withdrawing the continuation of a watching
+  // future.
+  void Disentangle() {
+    if (Promise<T>* promise = std::exchange(promise_, nullptr)) {
+      promise->DropFuture(/*abandoned=*/false);
+    }
+  }
+
+  // The entangled promise, until it delivers a value or `AndThen` hands it
+  // the continuation. Watching futures stay entangled until the value is
+  // delivered.
+  Promise<T>* promise_ = nullptr;
+  std::optional<T> value_;
+  bool active_ = false;
+};
+
+// ============
+//  Promise<T>
+// ============
+
+// The capability to set the value of the associated `Future<T>`.
+template <typename T>
+class Promise {
+ public:
+  Promise() = default;
+
+  // Promises are non-copyable.
+  Promise(const Promise&) = delete;
+  Promise& operator=(const Promise&) = delete;
+
+  // Promises are moveable. Moved-from promises are inactive.
+  Promise(Promise&& other) noexcept { MoveFrom(other); }
+  Promise& operator=(Promise&& other) noexcept {
+    if (this != &other) {
+      Break();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  // Destroying a promise without setting its value breaks it: a coroutine
+  // suspended on the future is destroyed, unless it awaits it through
+  // `AwaitOptional()`, and a continuation attached with `AndThen` is
+  // destroyed without running.
+  ~Promise() { Break(); }
+
+  // Gets the associated future for this promise. It is an error to call this
+  // function more than once.
+  Future<T> GetFuture() {
+    CHECK(active_ && !future_retrieved_);
+    future_retrieved_ = true;
+    return Future<T>(this);
+  }
+
+  // Returns true if the future has been destroyed or abandoned with nothing
+  // left to receive the value, so that producing it would be wasted work.
+  // The future tells its promise when it goes away, so this only reads the
+  // promise's own state.
+  bool IsAbandoned() const {
+    return active_ && future_retrieved_ && !future_ && !HasContinuation();
+  }
+
+  // Runs `callback` when the future is destroyed or abandoned before the
+  // value is set, or right away if `IsAbandoned()`. It runs synchronously,
+  // from within the future's destructor or `WhenAny`'s abandonment, and may
+  // destroy the promise. The callback is dropped once the value is set.
+  //
+  // Producers differ in what cancels them. For a promise held by hand, as
+  // here, by a `CrossSequencePromise`, or by `WithTimeout`, merely dropping
+  // the future counts as abandonment, the same as an explicit abandonment.
+  // A coroutine, or the inputs of a `WhenAny`, may have effects beyond the
+  // result, so dropping the coroutine's or the `WhenAny`'s future only
+  // discards the value, and they keep running. Only an abandonment cancels
+  // them, and that comes from `WhenAny` for its losers, from `WithTimeout` on
+  // expiry, or from destroying a coroutine suspended on the future.
+  void OnAbandoned(OnceClosure callback) {
+    CHECK(active_);
+    if (IsAbandoned()) {
+      std::move(callback).Run();
+      return;
+    }
+    on_abandoned_ = std::move(callback);
+  }
+
+  // As above, but notifies `observer`, which must outlive the promise or the
+  // setting of its value. At most one observer may be registered, and only
+  // with a promise that is not resolved by a coroutine or combinator.
+  void OnAbandoned(PromiseAbandonmentObserver* observer) {
+    CHECK(active_ && !observer_);
+    if (IsAbandoned()) {
+      observer->OnPromiseAbandoned();
+      return;
+    }
+    observer_ = observer;
+  }
+
+  // Sets the completed value of the associated future. Once called, the
+  // promise will become inactive. It is an error to call `SetValue` on an
+  // inactive promise.
+  void SetValue(T value) {
+    if (!Complete(value)) {
+      return;
+    }
+    scoped_refptr<SequencedTaskRunner> task_runner = std::move(task_runner_);
+    if (internal::FutureWaiter<T>* waiter = std::exchange(waiter_, nullptr)) {
+      waiter->value.emplace(std::move(value));
+      waiter->resumption_posted = true;
+      internal::PostContinuation(task_runner,
+                                 [waiter] { waiter->resume(waiter); });
+      return;
+    }
+    internal::PostContinuation(
+        task_runner, [continuation = std::move(continuation_),
+                      value = std::move(value)]() mutable {
+          std::move(continuation).Run(std::move(value));
+        });
+  }
+
+  // Sets the completed value of the associated future. If a callback has been
+  // registered for the associated future it will be executed synchronously.
+  void SetValueWithSideEffects(T value) {
+    if (!Complete(value)) {
+      return;
+    }
+    task_runner_ = nullptr;
+    if (internal::FutureWaiter<T>* waiter = std::exchange(waiter_, nullptr)) {
+      waiter->value.emplace(std::move(value));
+      waiter->resume(waiter);
+      return;
+    }
+    std::move(continuation_).Run(std::move(value));
+  }
+
+ private:
+  friend class Future<T>;
+  template <typename U>
+  friend class internal::FuturePromiseTypeBase;
+  friend struct internal::FutureAccess;
+
+  void MoveFrom(Promise& other) {
+    future_ = std::exchange(other.future_, nullptr);
+    continuation_ = std::move(other.continuation_);
+    waiter_ = std::exchange(other.waiter_, nullptr);
+    task_runner_ = std::move(other.task_runner_);
+    observer_ = std::exchange(other.observer_, nullptr);
+    on_abandoned_ = std::move(other.on_abandoned_);
+    active_ = std::exchange(other.active_, false);
+    future_retrieved_ = other.future_retrieved_;
+    if (future_) {
+      future_->promise_ = this;
+    }
+  }
+
+  void Disentangle() {
+    if (future_) {
+      future_->promise_ = nullptr;
+      future_ = nullptr;
+    }
+  }
+
+  // Disentangles the promise, and tells a coroutine suspended on the future
+  // that no value will come. The future and observer are released first, so
+  // that destroying the coroutine does not reach back into this promise.
+  void Break() {
+    internal::FutureWaiter<T>* waiter = std::exchange(waiter_, nullptr);
+    Disentangle();
+    observer_ = nullptr;
+    if (!waiter) {
+      return;
+    }
+    if (waiter->destroy) {
+      task_runner_ = nullptr;
+      waiter->destroy(waiter);
+      return;
+    }
+    waiter->resumption_posted = true;
+    internal::PostContinuation(std::move(task_runner_),
+                               [waiter] { waiter->resume(waiter); });
+  }
+
+  // These notify the observer last, as it may set the value or destroy the
+  // promise.
+  void SetContinuation(internal::FutureContinuation<T> continuation) {
+    continuation_ = std::move(continuation);
+    task_runner_ = SequencedTaskRunner::GetCurrentDefault();
+    if (observer_) {
+      observer_->OnContinuationSet();
+    }
+  }
+
+  void SetWaiter(internal::FutureWaiter<T>* waiter) {
+    waiter_ = waiter;
+    task_runner_ = SequencedTaskRunner::GetCurrentDefault();
+    if (observer_) {
+      observer_->OnContinuationSet();
+    }
+  }
+
+  void SetObserver(internal::PromiseObserver* observer) {
+    observer_ = observer;
+  }
+
+  bool HasContinuation() const { return !continuation_.is_null() || waiter_; }
+
+  // Called when the entangled future is destroyed or abandoned before the
+  // value is delivered.
+  void DropFuture(bool abandoned) {
+    future_ = nullptr;
+    waiter_ = nullptr;
+    task_runner_ = nullptr;
+    // The observer and the callback may destroy this promise, and the
+    // continuation may own whatever owns it, so release all three only once
+    // done with `this`.
+    internal::FutureContinuation<T> continuation = std::move(continuation_);
+    OnceClosure on_abandoned = std::move(on_abandoned_);
+    if (internal::PromiseObserver* observer =
+            std::exchange(observer_, nullptr)) {
+      observer->OnFutureDropped(abandoned);
+    }
+    if (on_abandoned) {
+      std::move(on_abandoned).Run();
+    }
+  }
+
+  // Marks the promise as completed. If the future has not yet been consumed,
+  // moves `value` into it and returns false. Otherwise returns true if a
+  // continuation is waiting for `value`.
+  bool Complete(T& value) {
+    CHECK(active_ && future_retrieved_);
+    active_ = false;
+    observer_ = nullptr;
+    on_abandoned_.Reset();
+    if (future_ && HasContinuation()) {
+      // A watching future: the continuation receives the value.
+      future_->promise_ = nullptr;
+      future_ = nullptr;
+      return true;
+    }
+    if (future_) {
+      future_->value_.emplace(std::move(value));
+      Disentangle();
+      return false;
+    }
+    return HasContinuation();
+  }
+
+  // The entangled future, until it is consumed by `AndThen` or, for a
+  // watching future, until the value is delivered.
+  Future<T>* future_ = nullptr;
+  // The continuation, if any: a callable, or a suspended coroutine.
+  internal::FutureContinuation<T> continuation_;
+  internal::FutureWaiter<T>* waiter_ = nullptr;
+  scoped_refptr<SequencedTaskRunner> task_runner_;
+  // Notified of the consumer's actions until the value is set.
+  internal::PromiseObserver* observer_ = nullptr;
+  // Set by `OnAbandoned()`.
+  OnceClosure on_abandoned_;
+  bool active_ = true;
+  bool future_retrieved_ = false;
+};
+
+namespace internal {
+
+// Gives combinators and coroutine support access to future internals.
+struct FutureAccess {
+  template <typename T>
+  static void Watch(Future<T>& future,
+                    FutureContinuation<T> continuation) {
+    future.Watch(std::move(continuation));
+  }
+
+  template <typename T>
+  static void Abandon(Future<T>& future) {
+    future.Abandon();
+  }
+
+  template <typename T>
+  static void AwaitWith(Future<T>& future, FutureWaiter<T>* waiter) {
+    future.AwaitWith(waiter);
+  }
+
+  // Whether a future that is not ready may still receive a value.
+  template <typename T>
+  static bool HasPromise(const Future<T>& future) {
+    return future.promise_ != nullptr;
+  }
+
+  template <typename T>
+  static void SetObserver(Promise<T>& promise, PromiseObserver* observer) {
+    promise.SetObserver(observer);
+  }
+};
+
+// Gives `MakeFuture` access to the state of a `CrossSequencePromise` that it
+// has handed to the producer.
+struct CrossSequencePromiseAccess {
+  template <typename T>
+  static auto* GetState(CrossSequencePromise<T>& promise) {
+    return promise.state_;
+  }
+};
+
+}  // namespace internal
+
+// ================================
+//  Future<void> and Promise<void>
+// ================================
+
+// Specializations for `Future<void>` and `Promise<void>` use `VoidFutureValue`
+// as the underlying value type and provide convenience overloads that allow
+// attaching callbacks that accept zero arguments.
+
+template <>
+class Future<void> : public Future<VoidFutureValue> {
+ public:
+  using ValueType = void;
+
+  Future() = default;
+  Future(Future<VoidFutureValue>&& other)
+      : Future<VoidFutureValue>(std::move(other)) {}
+
+  // Callable overloads are declared first, since the `OnceCallback` overloads
+  // below are defined in terms of them and their return types are deduced.
+  template <typename F>
+    requires(std::is_invocable_v<std::decay_t<F>>)
+  auto AndThen(F&& callback) && {
+    return AsBase().AndThen(
+        [callback = std::forward<F>(callback)](VoidFutureValue) mutable {
+          return std::invoke(std::move(callback));
+        });
+  }
+
+  template <typename F>
+    requires(std::is_invocable_v<std::decay_t<F>>)
+  auto Transform(F&& callback) && {
+    return AsBase().Transform(
+        [callback = std::forward<F>(callback)](VoidFutureValue) mutable {
+          return std::invoke(std::move(callback));
+        });
+  }
+
+  void AndThen(OnceCallback<void()> callback) && {
+    std::move(*this).AndThen([callback = std::move(callback)]() mutable {
+      std::move(callback).Run();
+    });
+  }
+
+  template <typename U>
+  Future<U> AndThen(OnceCallback<Future<U>()> callback) && {
+    return std::move(*this).AndThen(
+        [callback = std::move(callback)]() mutable {
+          return std::move(callback).Run();
+        });
+  }
+
+  template <typename U>
+  Future<U> Transform(OnceCallback<U()> callback) && {
+    return std::move(*this).Transform(
+        [callback = std::move(callback)]() mutable {
+          return std::move(callback).Run();
+        });
+  }
+
+  SharedFuture<void> Share() &&;
+
+ private:
+  Future<VoidFutureValue>&& AsBase() {
+    return static_cast<Future<VoidFutureValue>&&>(*this);
+  }
+};
+
+template <>
+class Promise<void> : public Promise<VoidFutureValue> {
+ public:
+  Promise() = default;
+
+  Future<void> GetFuture() { return Promise<VoidFutureValue>::GetFuture(); }
+
+  void SetValue() { Promise<VoidFutureValue>::SetValue(VoidFutureValue()); }
+
+  void SetValueWithSideEffects() {
+    Promise<VoidFutureValue>::SetValueWithSideEffects(VoidFutureValue());
+  }
+};
+
+// ===========
+//  Factories
+// ===========
+
+// Returns an already-available Future for the specified value.
+template <typename T>
+Future<T> MakeReadyFuture(T value) {
+  return Future<T>(std::in_place, std::move(value));
+}
+
+inline Future<void> MakeReadyFuture() {
+  return MakeReadyFuture(VoidFutureValue());
+}
+
+// Within a Future-returning coroutine, `co_await AwaitOptional(future)`
+// yields a `std::optional<T>` holding the value, or `std::nullopt` if the
+// future's promise is destroyed without one. For `Future<void>` it yields
+// whether the promise was resolved. A plain `co_await` would destroy the
+// coroutine instead.
+template <typename T>
+internal::OptionalFutureAwaitable<T> AwaitOptional(Future<T> future) {
+  return {std::move(future)};
+}
+
+// Within a coroutine returning `Future<expected<V, E>>`, `co_await
+// AwaitOrReturnError(future)` of a `Future<expected<U, G>>` yields the `U`
+// value. If the future holds an error instead, the coroutine returns it, as
+// if by `co_return unexpected(error)`: the error is moved straight into the
+// coroutine's result, and the frame is destroyed without running the rest of
+// the coroutine. This replaces the usual
+//
+//   expected<U, G> result = co_await std::move(future);
+//   if (!result.has_value()) {
+//     co_return unexpected(std::move(result).error());
+//   }
+template <typename T>
+  requires(internal::IsExpected<T>)
+internal::ValueOrReturnErrorFutureAwaitable<T> AwaitOrReturnError(
+    Future<T> future) {
+  return {std::move(future)};
+}
+
+namespace internal {
+
+template <typename... Args>
+struct MakeFutureTraits {
+  using ValueType = std::tuple<Args...>;
+
+  static ValueType MakeValue(Args... args) {
+    return ValueType(std::move(args)...);
+  }
+};
+
+template <typename T>
+struct MakeFutureTraits<T> {
+  using ValueType = T;
+
+  static T MakeValue(T value) { return value; }
+};
+
+template <>
+struct MakeFutureTraits<> {
+  using ValueType = void;
+
+  static VoidFutureValue MakeValue() { return VoidFutureValue(); }
+};
+
+template <>
+struct MakeFutureTraits<void> : MakeFutureTraits<> {};
+
+template <typename Traits, typename... Args>
+void ResolveFromAnySequence(
+    CrossSequencePromise<FutureStorageType<typename Traits::ValueType>>
+        promise,
+    Args... args) {
+  promise.SetValue(Traits::MakeValue(std::move(args)...));
+}
+
+template <typename Traits, typename... Args>
+auto MakeCrossSequenceCallback(
+    CrossSequencePromise<FutureStorageType<typename Traits::ValueType>>
+        promise) {
+  return BindOnce(&ResolveFromAnySequence<Traits, Args...>,
+                  std::move(promise));
+}
+
+}  // namespace internal
+
+// Creates a promise/future pair, and calls the specified function with a
+// callback of type `base::OnceCallback<void(Args...)>`. The Future value
+// type depends upon the number of type arguments supplied, as follows:
+//
+// - None (or `void`): `Future<void>`
+// - One: `Future<T>`
+// - More than one: `Future<std::tuple<Args...>>`
+//
+// When run, the callback function will set the value of the corresponding
+// promise object. It may be called from any sequence. It resolves a
+// `CrossSequencePromise`, so callbacks run on other sequences are delivered
+// in batches rather than by a task each.
+template <typename... Args, typename F>
+auto MakeFuture(F fn) {
+  using Traits = internal::MakeFutureTraits<Args...>;
+  using ValueType = typename Traits::ValueType;
+  using Storage = internal::FutureStorageType<ValueType>;
+
+  CrossSequencePromise<Storage> cross_sequence_promise;
+  Future<ValueType> future(cross_sequence_promise.GetFuture());
+  if constexpr (std::is_void_v<ValueType>) {
+    std::move(fn)(internal::MakeCrossSequenceCallback<Traits>(
+        std::move(cross_sequence_promise)));
+  } else {
+    std::move(fn)(internal::MakeCrossSequenceCallback<Traits, Args...>(
+        std::move(cross_sequence_promise)));
+  }
+  return future;
+}
+
+// As above, but `fn` returns a `OnceClosure` that stops the operation it
+// started, such as by cancelling its timer or forgetting its pending
+// request. The closure runs on this sequence if `token` is cancelled, or the
+// future is dropped or abandoned, before the callback's value is delivered.
+// On cancellation, the future's continuation is dropped along with it, and
+// the future is never resolved.
+//
+//   Future<Response> Fetch(Request request, const CancellationToken& token) {
+//     return MakeFuture<Response>(token, [&](auto callback) {
+//       RequestId id = client->Send(std::move(request), std::move(callback));
+//       return BindOnce(&Client::Forget, client->AsWeakPtr(), id);
+//     });
+//   }
+template <typename... Args, typename F>
+auto MakeFuture(const CancellationToken& token, F fn) {
+  using Traits = internal::MakeFutureTraits<Args...>;
+  using ValueType = typename Traits::ValueType;
+  using Storage = internal::FutureStorageType<ValueType>;
+
+  CrossSequencePromise<Storage> cross_sequence_promise;
+  Future<ValueType> future(cross_sequence_promise.GetFuture());
+  // The state is only deleted on this sequence, once the future has been
+  // dropped or given a continuation, so it outlives the call to `fn`.
+  auto* state =
+      internal::CrossSequencePromiseAccess::GetState(cross_sequence_promise);
+  OnceClosure teardown;
+  if constexpr (std::is_void_v<ValueType>) {
+    teardown = std::move(fn)(internal::MakeCrossSequenceCallback<Traits>(
+        std::move(cross_sequence_promise)));
+  } else {
+    teardown =
+        std::move(fn)(internal::MakeCrossSequenceCallback<Traits, Args...>(
+            std::move(cross_sequence_promise)));
+  }
+  state->SetTeardown(token, std::move(teardown));
+  return future;
+}
+
+}  // namespace base
+
+// Completes `CrossSequencePromise`, which `MakeFuture` uses.
+#include "base/futures/cross_sequence_promise.h"
+
+// Defines `Future::Share()`.
+#include "base/futures/shared_future.h"
+
+#endif  // BASE_FUTURES_FUTURE_H_
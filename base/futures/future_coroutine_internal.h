@@ -0,0 +1,547 @@
+#ifndef BASE_FUTURES_FUTURE_COROUTINE_INTERNAL_H_
+#define BASE_FUTURES_FUTURE_COROUTINE_INTERNAL_H_
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "base/check.h"
+#include "base/futures/coroutine_frame_allocator.h"
+#include "base/futures/promise_observer.h"
+#include "base/memory/weak_ptr.h"
+#include "base/types/expected.h"
+
+// Support for coroutines that return `base::Future<T>`. Included by
+// "base/futures/future.h"; do not include directly.
+
+namespace base {
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+template <typename T>
+class SharedFuture;
+
+struct VoidFutureValue;
+
+namespace internal {
+
+template <typename T>
+class SharedFutureAwaiter;
+
+// The object referenced by a coroutine parameter, or `void` if the parameter
+// is passed by value.
+template <typename Arg>
+struct CoroutineArgReferent {
+  using Type = void;
+};
+
+template <typename U>
+struct CoroutineArgReferent<U&> {
+  using Type = U;
+};
+
+template <typename U>
+struct CoroutineArgReferent<U&&> {
+  using Type = U;
+};
+
+template <typename U>
+struct CoroutineArgReferent<U*> {
+  using Type = U;
+};
+
+// Reference and pointer parameters (including the implicit object parameter
+// of member functions) must refer to an empty object, or to an object that
+// provides weak pointers through `AsWeakPtr()`.
+template <typename Arg>
+constexpr bool IsWeakCoroutineArg() {
+  using Referent = typename CoroutineArgReferent<Arg>::Type;
+  if constexpr (std::is_void_v<Referent>) {
+    return false;
+  } else {
+    return !std::is_empty_v<std::remove_cv_t<Referent>>;
+  }
+}
+
+template <typename U>
+concept HasAsWeakPtr = requires(U& object) { object.AsWeakPtr(); };
+
+// Produces a tuple holding the weak pointer for `Arg`, or an empty tuple if
+// `Arg` does not need one.
+template <typename Arg>
+struct CoroutineArgWeakPtr {
+  using Type = std::tuple<>;
+
+  static Type Get(Arg&) { return Type(); }
+};
+
+template <typename Arg>
+  requires(IsWeakCoroutineArg<Arg>())
+struct CoroutineArgWeakPtr<Arg> {
+  using Referent = typename CoroutineArgReferent<Arg>::Type;
+
+  static_assert(HasAsWeakPtr<Referent>,
+                "Reference and pointer arguments of Future-returning "
+                "coroutines must be empty or provide AsWeakPtr().");
+
+  using Type = std::tuple<decltype(std::declval<Referent&>().AsWeakPtr())>;
+
+  static Type Get(Arg& arg) {
+    if constexpr (std::is_pointer_v<Arg>) {
+      CHECK(arg);
+      return Type(arg->AsWeakPtr());
+    } else {
+      return Type(arg.AsWeakPtr());
+    }
+  }
+};
+
+// A coroutine that awaits a ready future continues synchronously instead of
+// posting its resumption. To keep a coroutine that awaits many ready futures
+// in a row from monopolizing its sequence, at most `kMaxInlineResumptions`
+// consecutive resumptions of one coroutine happen inline; the next one is
+// posted, which refills that coroutine's budget. Inline resumption does not
+// grow the stack: the awaiting coroutine simply does not suspend.
+inline constexpr int kMaxInlineResumptions = 64;
+
+inline bool& InlineResumptionDisabledForTesting() {
+  thread_local bool disabled = false;
+  return disabled;
+}
+
+// Makes every `co_await` of a ready future on the current thread post its
+// resumption, as if the future were pending. For benchmarks and tests.
+class ScopedDisableInlineResumptionForTesting {
+ public:
+  ScopedDisableInlineResumptionForTesting()
+      : previous_(std::exchange(InlineResumptionDisabledForTesting(), true)) {}
+  ScopedDisableInlineResumptionForTesting(
+      const ScopedDisableInlineResumptionForTesting&) = delete;
+  ScopedDisableInlineResumptionForTesting& operator=(
+      const ScopedDisableInlineResumptionForTesting&) = delete;
+  ~ScopedDisableInlineResumptionForTesting() {
+    InlineResumptionDisabledForTesting() = previous_;
+  }
+
+ private:
+  const bool previous_;
+};
+
+// A coroutine suspended on a pending future. The future's promise holds a
+// pointer to the waiter in place of a callback; once resolved, it moves the
+// value into `value` and schedules `resume(this)`, neither of which
+// allocates.
+struct FutureWaiterBase {
+  void (*resume)(void* waiter) = nullptr;
+  // Called if the promise is destroyed without a value, to destroy the
+  // coroutine. If null, the coroutine is resumed without a value instead.
+  void (*destroy)(void* waiter) = nullptr;
+  // Set once the resumption has been posted, after which the coroutine must
+  // stay alive to receive it.
+  bool resumption_posted = false;
+};
+
+template <typename Storage>
+struct FutureWaiter : FutureWaiterBase {
+  std::optional<Storage> value;
+};
+
+// Awaiting `AwaitOptional(future)` yields `std::optional<T>` (or, for
+// `Future<void>`, a bool), which is empty if the future's promise is
+// destroyed without a value. A plain `co_await` of such a future destroys the
+// awaiting coroutine instead.
+template <typename T>
+struct OptionalFutureAwaitable {
+  Future<T> future;
+};
+
+// Awaiting `AwaitOrReturnError(future)`, for a future of an `expected`,
+// yields its value, or completes the awaiting coroutine with its error.
+template <typename T>
+struct ValueOrReturnErrorFutureAwaitable {
+  Future<T> future;
+};
+
+// How a `co_await` delivers the value of a future.
+enum class FutureAwaitMode {
+  // Yields the value.
+  kValue,
+  // Yields `std::optional<T>`, or a bool for `Future<void>`, for
+  // `AwaitOptional()`.
+  kOptional,
+  // Yields the value of an `expected`, or returns its error, for
+  // `AwaitOrReturnError()`.
+  kValueOrReturnError,
+};
+
+template <typename T, FutureAwaitMode kMode>
+struct FutureAwaitResult {
+  using Type = T;
+};
+
+template <typename T>
+struct FutureAwaitResult<T, FutureAwaitMode::kOptional> {
+  using Type = std::optional<T>;
+};
+
+template <>
+struct FutureAwaitResult<void, FutureAwaitMode::kOptional> {
+  using Type = bool;
+};
+
+template <typename T>
+struct FutureAwaitResult<T, FutureAwaitMode::kValueOrReturnError> {
+  using Type = typename T::value_type;
+};
+
+template <typename T, FutureAwaitMode kMode = FutureAwaitMode::kValue>
+class FutureAwaiter
+    : public FutureWaiter<
+          std::conditional_t<std::is_void_v<T>, VoidFutureValue, T>> {
+ public:
+  using Storage = std::conditional_t<std::is_void_v<T>, VoidFutureValue, T>;
+  using ResultType = typename FutureAwaitResult<T, kMode>::Type;
+
+  explicit FutureAwaiter(Future<Storage> future) : future_(std::move(future)) {}
+
+  // The awaiter is only destroyed before the value arrives if its coroutine
+  // was abandoned, in which case so is the future it was waiting for.
+  ~FutureAwaiter() { future_.Abandon(); }
+
+  bool await_ready() const { return false; }
+
+  // Returns false to continue the coroutine immediately with a ready value.
+  template <typename PromiseType>
+  bool await_suspend(std::coroutine_handle<PromiseType> handle) {
+    if (!handle.promise().CanResume()) {
+      // A weak argument was invalidated while the coroutine was running. Its
+      // observer has fired already, so nothing else would destroy the frame
+      // while it waits.
+      handle.destroy();
+      return true;
+    }
+    if (!future_.is_ready() && !future_.promise_) {
+      // The promise was destroyed without a value before the `co_await`, so
+      // it will never resume the frame, nor destroy it.
+      if constexpr (kMode == FutureAwaitMode::kOptional) {
+        // Continues with an empty value.
+        return false;
+      } else {
+        handle.destroy();
+        return true;
+      }
+    }
+    if (future_.is_ready() && handle.promise().TryConsumeInlineResumption()) {
+      this->value.emplace(std::move(future_).GetValueSynchronously());
+      return ReturnErrorIfAny(handle);
+    }
+    handle_ = handle;
+    this->resume = &FutureAwaiter::Resume<PromiseType>;
+    if constexpr (kMode != FutureAwaitMode::kOptional) {
+      this->destroy = &FutureAwaiter::Destroy<PromiseType>;
+    }
+    // A ready value is delivered by a posted resumption, which must find
+    // the frame alive; only a frame waiting on a pending future may be
+    // destroyed if abandoned.
+    if (future_.is_ready()) {
+      this->resumption_posted = true;
+    }
+    handle.promise().set_waiter(this);
+    future_.AwaitWith(this);
+    return true;
+  }
+
+  ResultType await_resume() {
+    if constexpr (kMode == FutureAwaitMode::kOptional) {
+      if constexpr (std::is_void_v<T>) {
+        return this->value.has_value();
+      } else {
+        return std::move(this->value);
+      }
+    } else if constexpr (kMode == FutureAwaitMode::kValueOrReturnError) {
+      if constexpr (!std::is_void_v<ResultType>) {
+        return std::move(**this->value);
+      }
+    } else if constexpr (!std::is_void_v<T>) {
+      return std::move(*this->value);
+    }
+  }
+
+ private:
+  template <typename PromiseType>
+  static void Resume(void* waiter) {
+    auto* self = static_cast<FutureAwaiter*>(
+        static_cast<FutureWaiter<Storage>*>(waiter));
+    auto handle =
+        std::coroutine_handle<PromiseType>::from_address(self->handle_.address());
+    handle.promise().set_waiter(nullptr);
+    handle.promise().RefillInlineResumptionBudget();
+    if (!handle.promise().CanResume()) {
+      // Destroying the frame also destroys this awaiter.
+      handle.destroy();
+      return;
+    }
+    if (self->ReturnErrorIfAny(handle)) {
+      return;
+    }
+    handle.resume();
+  }
+
+  // For `AwaitOrReturnError()`: if the value is an error, completes the
+  // coroutine with it, as `co_return` would, and destroys the frame instead
+  // of running the rest of the coroutine. Returns whether it did.
+  template <typename PromiseType>
+  bool ReturnErrorIfAny(std::coroutine_handle<PromiseType> handle) {
+    if constexpr (kMode == FutureAwaitMode::kValueOrReturnError) {
+      if (!this->value->has_value()) {
+        handle.promise().ReturnError(std::move(*this->value).error());
+        // Destroying the frame also destroys this awaiter.
+        handle.destroy();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The promise was destroyed without a value, so the coroutine could never
+  // resume; destroying it releases its frame and whatever the frame owns.
+  template <typename PromiseType>
+  static void Destroy(void* waiter) {
+    auto* self = static_cast<FutureAwaiter*>(
+        static_cast<FutureWaiter<Storage>*>(waiter));
+    std::coroutine_handle<PromiseType>::from_address(self->handle_.address())
+        .destroy();
+  }
+
+  Future<Storage> future_;
+  std::coroutine_handle<> handle_;
+};
+
+// Promise type members shared by all Future-returning coroutines.
+template <typename T>
+class FuturePromiseTypeBase {
+ public:
+  using Storage = std::conditional_t<std::is_void_v<T>, VoidFutureValue, T>;
+
+  Future<T> get_return_object() { return Future<T>(promise_.GetFuture()); }
+
+  // Coroutines run eagerly until their first suspension point, and their
+  // frames are destroyed as soon as they complete.
+  std::suspend_never initial_suspend() noexcept { return {}; }
+  std::suspend_never final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() { NOTREACHED(); }
+
+  // Frames are recycled through per-sequence free lists.
+  static void* operator new(size_t size) {
+    return CoroutineFrameAllocator::Allocate(size);
+  }
+  static void operator delete(void* frame, size_t size) {
+    CoroutineFrameAllocator::Free(frame, size);
+  }
+
+  template <typename U>
+  FutureAwaiter<U> await_transform(Future<U>&& future) {
+    return FutureAwaiter<U>(std::move(future));
+  }
+
+  template <typename U>
+  FutureAwaiter<U, FutureAwaitMode::kOptional> await_transform(
+      OptionalFutureAwaitable<U>&& awaitable) {
+    return FutureAwaiter<U, FutureAwaitMode::kOptional>(
+        std::move(awaitable.future));
+  }
+
+  template <typename U>
+  FutureAwaiter<U, FutureAwaitMode::kValueOrReturnError> await_transform(
+      ValueOrReturnErrorFutureAwaitable<U>&& awaitable) {
+    if constexpr (IsExpected<T>) {
+      static_assert(std::is_constructible_v<typename T::error_type,
+                                            typename U::error_type&&>,
+                    "The awaited error must convert to the coroutine's.");
+    } else {
+      static_assert(IsExpected<T>,
+                    "AwaitOrReturnError() requires a coroutine returning "
+                    "Future<expected<V, E>>.");
+    }
+    return FutureAwaiter<U, FutureAwaitMode::kValueOrReturnError>(
+        std::move(awaitable.future));
+  }
+
+  // `co_await` of a `SharedFuture` yields a reference to its value.
+  template <typename U>
+  auto await_transform(const SharedFuture<U>& future) {
+    using SharedStorage =
+        std::conditional_t<std::is_void_v<U>, VoidFutureValue, U>;
+    return SharedFutureAwaiter<SharedStorage>(future.state_);
+  }
+
+  // Completes the coroutine with `error`, for `AwaitOrReturnError()`. The
+  // frame is destroyed next, without running to its end.
+  template <typename E>
+  void ReturnError(E&& error) {
+    ClearPromiseObserver();
+    promise_.SetValue(Storage(unexpect, std::forward<E>(error)));
+  }
+
+  // Consumes one unit of the inline resumption budget, if any is left.
+  bool TryConsumeInlineResumption() {
+    if (inline_resumptions_left_ == 0 ||
+        InlineResumptionDisabledForTesting()) {
+      return false;
+    }
+    --inline_resumptions_left_;
+    return true;
+  }
+
+  void RefillInlineResumptionBudget() {
+    inline_resumptions_left_ = kMaxInlineResumptions;
+  }
+
+  // Whether the coroutine is suspended waiting on a pending future, and so
+  // may be destroyed if its own future is abandoned.
+  bool suspended() const { return waiter_ && !waiter_->resumption_posted; }
+
+  // Set while the coroutine is suspended on a future.
+  void set_waiter(FutureWaiterBase* waiter) { waiter_ = waiter; }
+
+ protected:
+  void SetPromiseObserver(PromiseObserver* observer) {
+    promise_.SetObserver(observer);
+  }
+
+  // Once the coroutine returns, there is no frame left to destroy.
+  void ClearPromiseObserver() { promise_.SetObserver(nullptr); }
+
+  Promise<Storage> promise_;
+
+ private:
+  int inline_resumptions_left_ = kMaxInlineResumptions;
+  FutureWaiterBase* waiter_ = nullptr;
+};
+
+template <typename T, bool = std::is_void_v<T>>
+class FuturePromiseTypeReturn : public FuturePromiseTypeBase<T> {
+ public:
+  // `co_return T`: sets the value of the underlying promise.
+  void return_value(T value) {
+    this->ClearPromiseObserver();
+    this->promise_.SetValue(std::move(value));
+  }
+
+  // `co_return Future<T>`: sets the value of the underlying promise once
+  // `future` is available.
+  void return_value(Future<T> future) {
+    this->ClearPromiseObserver();
+    std::move(future).AndThen(
+        [promise = std::move(this->promise_)](T value) mutable {
+          promise.SetValueWithSideEffects(std::move(value));
+        });
+  }
+};
+
+template <typename T>
+class FuturePromiseTypeReturn<T, true> : public FuturePromiseTypeBase<T> {
+ public:
+  void return_void() {
+    this->ClearPromiseObserver();
+    this->promise_.SetValue(VoidFutureValue());
+  }
+};
+
+// The promise type of a coroutine returning `Future<T>` with parameter types
+// `Args`. The weak references of reference and pointer parameters are
+// observed from the time the frame is created, and the coroutine is destroyed
+// instead of resumed if any of them has been invalidated; if it is suspended
+// on a pending future at the time, it is destroyed right away. It is also
+// destroyed if its future is abandoned while it is suspended.
+template <typename T, typename... Args>
+class FuturePromiseType : public FuturePromiseTypeReturn<T>,
+                          public PromiseObserver {
+ public:
+  explicit FuturePromiseType(Args&... args) {
+    this->SetPromiseObserver(this);
+    if constexpr (kNumWeakArgs > 0) {
+      WeakPtrs weak_ptrs =
+          std::tuple_cat(CoroutineArgWeakPtr<Args>::Get(args)...);
+      [&]<size_t... Is>(std::index_sequence<Is...>) {
+        weak_arg_invalidated_ =
+            !(weak_arg_observers_[Is].Observe(
+                  this, std::move(std::get<Is>(weak_ptrs))) &&
+              ...);
+      }(std::make_index_sequence<kNumWeakArgs>());
+    }
+  }
+
+  // The liveness of all weak arguments is tracked by their observers, so
+  // checking it costs a single load however many there are, and nothing if
+  // there are none.
+  bool CanResume() const {
+    if constexpr (kNumWeakArgs == 0) {
+      return true;
+    } else {
+      return !weak_arg_invalidated_;
+    }
+  }
+
+ private:
+  // PromiseObserver:
+  void OnFutureDropped(bool abandoned) override {
+    if (abandoned && this->suspended()) {
+      std::coroutine_handle<FuturePromiseType>::from_promise(*this).destroy();
+    }
+  }
+
+  using WeakPtrs = decltype(std::tuple_cat(
+      std::declval<typename CoroutineArgWeakPtr<Args>::Type>()...));
+
+  static constexpr size_t kNumWeakArgs = std::tuple_size_v<WeakPtrs>;
+
+  class WeakArgObserver : public WeakReferenceObserver {
+   public:
+    template <typename WeakPtrType>
+    bool Observe(FuturePromiseType* promise, WeakPtrType weak_ptr) {
+      promise_ = promise;
+      return WeakReferenceObserver::Observe(std::move(weak_ptr));
+    }
+
+    // WeakReferenceObserver:
+    void OnWeakReferenceInvalidated() override {
+      promise_->OnWeakArgInvalidated();
+    }
+
+   private:
+    FuturePromiseType* promise_ = nullptr;
+  };
+
+  // A frame suspended on a pending future is destroyed as soon as one of
+  // its objects is, rather than when the future resolves, which may be never.
+  // Frames that are running or about to be resumed are left to `CanResume()`.
+  void OnWeakArgInvalidated() {
+    weak_arg_invalidated_ = true;
+    if (this->suspended()) {
+      std::coroutine_handle<FuturePromiseType>::from_promise(*this).destroy();
+    }
+  }
+
+  std::array<WeakArgObserver, kNumWeakArgs> weak_arg_observers_;
+  bool weak_arg_invalidated_ = false;
+};
+
+}  // namespace internal
+}  // namespace base
+
+template <typename T, typename... Args>
+struct std::coroutine_traits<base::Future<T>, Args...> {
+  using promise_type = base::internal::FuturePromiseType<T, Args...>;
+};
+
+#endif  // BASE_FUTURES_FUTURE_COROUTINE_INTERNAL_H_
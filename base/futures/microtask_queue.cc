@@ -0,0 +1,49 @@
+#include "base/futures/microtask_queue.h"
+
+#include "base/check.h"
+#include "base/threading/sequence_local_storage_map.h"
+#include "base/threading/sequence_local_storage_slot.h"
+
+namespace base::internal {
+
+// static
+MicrotaskQueue* MicrotaskQueue::GetForTaskRunningOn(
+    const SequencedTaskRunner& task_runner) {
+  if (!task_runner.RunsTasksInCurrentSequence() || !CurrentThread::IsSet() ||
+      !CurrentThread::Get().IsRunningTask() ||
+      !SequenceLocalStorageMap::IsSetForCurrentThread()) {
+    return nullptr;
+  }
+  static SequenceLocalStorageSlot<MicrotaskQueue> slot;
+  return &slot.GetOrCreateValue();
+}
+
+MicrotaskQueue::MicrotaskQueue() : current_thread_(CurrentThread::Get()) {
+  current_thread_.AddTaskObserver(this);
+}
+
+MicrotaskQueue::~MicrotaskQueue() {
+  current_thread_.RemoveTaskObserver(this);
+}
+
+void MicrotaskQueue::Enqueue(Microtask microtask) {
+  DCHECK(current_thread_.IsRunningTask());
+  microtasks_.push_back(std::move(microtask));
+}
+
+void MicrotaskQueue::DidProcessTask() {
+  RunMicrotasks();
+}
+
+void MicrotaskQueue::RunMicrotasks() {
+  // Microtasks may enqueue more microtasks, or run a nested loop that drains
+  // the queue, so re-check the bounds on every iteration.
+  while (next_microtask_ < microtasks_.size()) {
+    Microtask microtask = std::move(microtasks_[next_microtask_++]);
+    std::move(microtask).Run();
+  }
+  microtasks_.clear();
+  next_microtask_ = 0;
+}
+
+}  // namespace base::internal
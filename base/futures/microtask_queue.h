@@ -0,0 +1,76 @@
+#ifndef BASE_FUTURES_MICROTASK_QUEUE_H_
+#define BASE_FUTURES_MICROTASK_QUEUE_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "base/functional/bind.h"
+#include "base/functional/inline_once_callable.h"
+#include "base/location.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/current_thread.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/task_observer.h"
+
+namespace base::internal {
+
+// Runs future continuations that become runnable during a task on the
+// current sequence. Rather than posting a task per continuation, they are
+// appended to a per-sequence queue that is drained when the current task
+// completes, and continuations queued while draining run in the same drain. A
+// chain of N resolutions started inside a task therefore posts no tasks, and
+// one started outside of a task posts one. Continuations still never run
+// inside the call that made them runnable.
+class MicrotaskQueue : public TaskObserver {
+ public:
+  // Large enough for a future continuation together with a small value, so
+  // that queueing one does not allocate.
+  static constexpr size_t kMicrotaskInlineSize = 96;
+  using Microtask = InlineOnceCallable<void(), kMicrotaskInlineSize>;
+
+  // Returns the current sequence's queue, creating it if necessary, if a task
+  // is running on the current thread and `task_runner` runs its tasks here.
+  // Returns null otherwise.
+  static MicrotaskQueue* GetForTaskRunningOn(
+      const SequencedTaskRunner& task_runner);
+
+  MicrotaskQueue();
+  MicrotaskQueue(const MicrotaskQueue&) = delete;
+  MicrotaskQueue& operator=(const MicrotaskQueue&) = delete;
+  ~MicrotaskQueue() override;
+
+  // Queues `microtask` to run when the current task completes. Must be called
+  // while a task is running.
+  void Enqueue(Microtask microtask);
+
+  // TaskObserver:
+  void WillProcessTask() override {}
+  void DidProcessTask() override;
+
+ private:
+  void RunMicrotasks();
+
+  CurrentThread current_thread_;
+  std::vector<Microtask> microtasks_;
+  size_t next_microtask_ = 0;
+};
+
+// Runs the callable `continuation` on `task_runner`'s sequence in a later
+// turn: as a microtask if a task is running on that sequence, and as a posted
+// task otherwise.
+template <typename F>
+void PostContinuation(const scoped_refptr<SequencedTaskRunner>& task_runner,
+                      F&& continuation) {
+  if (MicrotaskQueue* microtask_queue =
+          MicrotaskQueue::GetForTaskRunningOn(*task_runner)) {
+    microtask_queue->Enqueue(
+        MicrotaskQueue::Microtask(std::forward<F>(continuation)));
+    return;
+  }
+  task_runner->PostTask(FROM_HERE, BindOnce(std::forward<F>(continuation)));
+}
+
+}  // namespace base::internal
+
+#endif  // BASE_FUTURES_MICROTASK_QUEUE_H_
@@ -0,0 +1,108 @@
+#ifndef BASE_FUTURES_POST_TASK_H_
+#define BASE_FUTURES_POST_TASK_H_
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/futures/cross_sequence_promise.h"
+#include "base/futures/future.h"
+#include "base/location.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+namespace internal {
+
+// Runs `fn` on the future's own sequence. The task was posted for this, so
+// the continuation runs right away, rather than in a further turn.
+template <typename R, typename F>
+void RunTaskWithPromise(F fn, Promise<FutureStorageType<R>> promise) {
+  if (promise.IsAbandoned()) {
+    return;
+  }
+  if constexpr (std::is_void_v<R>) {
+    std::invoke(std::move(fn));
+    promise.SetValueWithSideEffects(VoidFutureValue());
+  } else {
+    promise.SetValueWithSideEffects(std::invoke(std::move(fn)));
+  }
+}
+
+// Runs `fn` on another sequence, whence the value is delivered through the
+// consumer sequence's mailbox.
+template <typename R, typename F>
+void RunTaskWithCrossSequencePromise(
+    F fn,
+    CrossSequencePromise<FutureStorageType<R>> promise) {
+  if (promise.IsAbandoned()) {
+    return;
+  }
+  if constexpr (std::is_void_v<R>) {
+    std::invoke(std::move(fn));
+    promise.SetValue(VoidFutureValue());
+  } else {
+    promise.SetValue(std::invoke(std::move(fn)));
+  }
+}
+
+}  // namespace internal
+
+// Posts `fn`, a callable returning `R`, to `task_runner`, and returns a future
+// for its result on the current sequence, which must have a default task
+// runner. The future overload of a task and its reply:
+//
+//   Future<Thumbnail> thumbnail = PostTaskWithResult(
+//       worker_task_runner, FROM_HERE,
+//       [image = std::move(image)] { return ScaleDown(image); });
+//
+// The result does not travel back in a reply task of its own. If
+// `task_runner` runs tasks on the current sequence, the task resolves the
+// future itself, and posts nothing further. Otherwise it resolves a
+// `CrossSequencePromise`, whose value is delivered by at most one task,
+// shared with the other results arriving on this sequence at the time, or by
+// none if no continuation is attached yet. If the future is dropped or
+// abandoned before the task runs, `fn` is destroyed without running. If the
+// task cannot be posted, the promise is destroyed with it, which breaks the
+// future: a coroutine awaiting it is destroyed, or gets `std::nullopt` through
+// `AwaitOptional()`, and a continuation attached with `AndThen` is destroyed
+// without running.
+template <typename F, typename R = std::invoke_result_t<F>>
+  requires(!internal::IsFuture<R>)
+Future<R> PostTaskWithResult(
+    const scoped_refptr<SequencedTaskRunner>& task_runner,
+    const Location& from_here,
+    F fn) {
+  using Storage = internal::FutureStorageType<R>;
+  if (task_runner->RunsTasksInCurrentSequence()) {
+    Promise<Storage> promise;
+    Future<R> future(promise.GetFuture());
+    task_runner->PostTask(
+        from_here, BindOnce(&internal::RunTaskWithPromise<R, F>,
+                            std::move(fn), std::move(promise)));
+    return future;
+  }
+  CrossSequencePromise<Storage> promise;
+  Future<R> future(promise.GetFuture());
+  task_runner->PostTask(
+      from_here, BindOnce(&internal::RunTaskWithCrossSequencePromise<R, F>,
+                          std::move(fn), std::move(promise)));
+  return future;
+}
+
+template <typename R>
+Future<R> PostTaskWithResult(
+    const scoped_refptr<SequencedTaskRunner>& task_runner,
+    const Location& from_here,
+    OnceCallback<R()> task) {
+  return PostTaskWithResult(
+      task_runner, from_here,
+      [task = std::move(task)]() mutable { return std::move(task).Run(); });
+}
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_POST_TASK_H_
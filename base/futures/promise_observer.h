@@ -0,0 +1,55 @@
+#ifndef BASE_FUTURES_PROMISE_OBSERVER_H_
+#define BASE_FUTURES_PROMISE_OBSERVER_H_
+
+namespace base::internal {
+
+// Observes the consumer side of a promise whose value is produced elsewhere,
+// such as by a coroutine or another sequence. At most one observer may be
+// set, and it is notified on the promise's sequence until the value is set.
+class PromiseObserver {
+ public:
+  // Called when a continuation or suspended coroutine is attached to the
+  // promise's future. May set the value or destroy the promise.
+  virtual void OnContinuationSet() {}
+
+  // Called when the future is destroyed before the value is delivered, and
+  // with `abandoned` true if it was abandoned, e.g. as the loser of
+  // `WhenAny`. May destroy the promise.
+  virtual void OnFutureDropped(bool abandoned) = 0;
+
+ protected:
+  virtual ~PromiseObserver() = default;
+};
+
+}  // namespace base::internal
+
+namespace base {
+
+template <typename T>
+class Promise;
+
+// Notified when the future of a promise is destroyed or abandoned before the
+// value is set, for producers that can stop their work then. Unlike a
+// callback passed to `Promise::OnAbandoned()`, registering an observer does
+// not allocate, so it suits producers that are objects of their own, such as
+// the responder of a pending request.
+class PromiseAbandonmentObserver : private internal::PromiseObserver {
+ public:
+  // Runs synchronously, from within the future's destructor or `WhenAny`'s
+  // abandonment. May destroy the promise.
+  virtual void OnPromiseAbandoned() = 0;
+
+ protected:
+  ~PromiseAbandonmentObserver() override = default;
+
+ private:
+  template <typename T>
+  friend class Promise;
+
+  // internal::PromiseObserver:
+  void OnFutureDropped(bool /*abandoned*/) final { OnPromiseAbandoned(); }
+};
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_PROMISE_OBSERVER_H_
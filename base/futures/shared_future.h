@@ -0,0 +1,360 @@
+#ifndef BASE_FUTURES_SHARED_FUTURE_H_
+#define BASE_FUTURES_SHARED_FUTURE_H_
+
+#include <coroutine>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/functional/inline_once_callable.h"
+#include "base/futures/future.h"
+#include "base/futures/microtask_queue.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+namespace internal {
+
+// A coroutine suspended on a `SharedFuture`. Waiters are linked into the
+// shared state's circular list, with the state's own node as its head, so
+// that suspending does not allocate however many coroutines wait.
+struct SharedFutureWaiter : FutureWaiterBase {
+  SharedFutureWaiter() = default;
+  SharedFutureWaiter(const SharedFutureWaiter&) = delete;
+  SharedFutureWaiter& operator=(const SharedFutureWaiter&) = delete;
+  ~SharedFutureWaiter() {
+    if (next) {
+      Unlink();
+    }
+  }
+
+  void LinkBefore(SharedFutureWaiter& head) {
+    prev = head.prev;
+    next = &head;
+    head.prev->next = this;
+    head.prev = this;
+  }
+
+  void Unlink() {
+    prev->next = next;
+    next->prev = prev;
+    prev = next = nullptr;
+  }
+
+  SharedFutureWaiter* prev = nullptr;
+  SharedFutureWaiter* next = nullptr;
+};
+
+// The value of a `SharedFuture`, and the callbacks and coroutines waiting for
+// it. Until the value arrives, the state waits on the source future as a
+// suspended coroutine would, so that the value is moved straight into it, and
+// keeps itself alive to receive it.
+template <typename T>
+class SharedFutureState final : public RefCounted<SharedFutureState<T>>,
+                                private FutureWaiter<T> {
+ public:
+  using Callback =
+      InlineOnceCallable<void(const T&), kFutureContinuationInlineSize>;
+
+  explicit SharedFutureState(Future<T> source) : source_(std::move(source)) {
+    waiters_.prev = waiters_.next = &waiters_;
+  }
+
+  // Must be called once, after construction, to wait for the source.
+  void Start() {
+    if (source_.is_ready()) {
+      this->value.emplace(std::move(source_).GetValueSynchronously());
+      return;
+    }
+    if (!FutureAccess::HasPromise(source_)) {
+      // The promise was destroyed without a value.
+      broken_ = true;
+      return;
+    }
+    self_ = scoped_refptr<SharedFutureState>(this);
+    this->resume = &SharedFutureState::OnValue;
+    this->destroy = &SharedFutureState::OnBroken;
+    FutureAccess::AwaitWith(source_, static_cast<FutureWaiter<T>*>(this));
+  }
+
+  bool is_ready() const { return this->value.has_value(); }
+  bool is_broken() const { return broken_; }
+
+  const T& GetValue() const {
+    CHECK(is_ready());
+    return *this->value;
+  }
+
+  // Runs `callback` with the value once it is available, in a future turn if
+  // it already is. Drops it if the source's promise is broken.
+  void AddCallback(Callback callback) {
+    if (is_ready()) {
+      PostContinuation(SequencedTaskRunner::GetCurrentDefault(),
+                       [state = scoped_refptr<SharedFutureState>(this),
+                        callback = std::move(callback)]() mutable {
+                         std::move(callback).Run(*state->value);
+                       });
+      return;
+    }
+    if (!broken_) {
+      callbacks_.push_back(std::move(callback));
+    }
+  }
+
+  // Resumes `waiter` with the value once it is available, or destroys it if
+  // the source's promise is broken.
+  void AddWaiter(SharedFutureWaiter& waiter) {
+    DCHECK(!is_ready() && !broken_);
+    waiter.LinkBefore(waiters_);
+  }
+
+ private:
+  friend class RefCounted<SharedFutureState>;
+
+  ~SharedFutureState() = default;
+
+  static SharedFutureState* FromWaiter(void* waiter) {
+    return static_cast<SharedFutureState*>(
+        static_cast<FutureWaiter<T>*>(waiter));
+  }
+
+  // Run, like a coroutine's resumption, by the source's promise: in a posted
+  // continuation, or synchronously from `SetValueWithSideEffects`.
+  static void OnValue(void* waiter) {
+    SharedFutureState* state = FromWaiter(waiter);
+    scoped_refptr<SharedFutureState> self = std::move(state->self_);
+    std::vector<Callback> callbacks = std::move(state->callbacks_);
+    for (Callback& callback : callbacks) {
+      std::move(callback).Run(*state->value);
+    }
+    // Coroutines resumed here may suspend on this future again, or destroy
+    // one another, so take them one at a time from a list of their own.
+    SharedFutureWaiter waiting;
+    state->TakeWaiters(waiting);
+    while (waiting.next != &waiting) {
+      SharedFutureWaiter* next = waiting.next;
+      next->Unlink();
+      next->resume(next);
+    }
+  }
+
+  static void OnBroken(void* waiter) {
+    SharedFutureState* state = FromWaiter(waiter);
+    scoped_refptr<SharedFutureState> self = std::move(state->self_);
+    state->broken_ = true;
+    std::vector<Callback> callbacks = std::move(state->callbacks_);
+    SharedFutureWaiter waiting;
+    state->TakeWaiters(waiting);
+    while (waiting.next != &waiting) {
+      SharedFutureWaiter* next = waiting.next;
+      next->Unlink();
+      next->destroy(next);
+    }
+  }
+
+  // Moves the list of waiters to `to`, which must be unlinked.
+  void TakeWaiters(SharedFutureWaiter& to) {
+    if (waiters_.next == &waiters_) {
+      to.prev = to.next = &to;
+      return;
+    }
+    to.next = waiters_.next;
+    to.prev = waiters_.prev;
+    to.next->prev = &to;
+    to.prev->next = &to;
+    waiters_.prev = waiters_.next = &waiters_;
+  }
+
+  Future<T> source_;
+  // Held while waiting on `source_`.
+  scoped_refptr<SharedFutureState> self_;
+  std::vector<Callback> callbacks_;
+  SharedFutureWaiter waiters_;
+  bool broken_ = false;
+};
+
+// Awaits a `SharedFuture` from a Future-returning coroutine, yielding a
+// reference to the shared value.
+template <typename T>
+class SharedFutureAwaiter : public SharedFutureWaiter {
+ public:
+  explicit SharedFutureAwaiter(scoped_refptr<SharedFutureState<T>> state)
+      : state_(std::move(state)) {
+    CHECK(state_);
+  }
+
+  bool await_ready() const { return false; }
+
+  // Returns false to continue the coroutine immediately with a ready value.
+  template <typename PromiseType>
+  bool await_suspend(std::coroutine_handle<PromiseType> handle) {
+    // As with a plain `co_await` of a future whose promise broke before it
+    // was awaited, or of any future by a coroutine whose weak argument was
+    // invalidated while it ran, the frame is destroyed right away: nothing
+    // would resume or destroy it later.
+    if (state_->is_broken() || !handle.promise().CanResume()) {
+      handle.destroy();
+      return true;
+    }
+    if (state_->is_ready() && handle.promise().TryConsumeInlineResumption()) {
+      return false;
+    }
+    handle_ = handle;
+    this->resume = &SharedFutureAwaiter::Resume<PromiseType>;
+    this->destroy = &SharedFutureAwaiter::Destroy<PromiseType>;
+    handle.promise().set_waiter(this);
+    if (state_->is_ready()) {
+      this->resumption_posted = true;
+      PostContinuation(SequencedTaskRunner::GetCurrentDefault(),
+                       [waiter = this] { waiter->resume(waiter); });
+      return true;
+    }
+    state_->AddWaiter(*this);
+    return true;
+  }
+
+  const T& await_resume() const { return state_->GetValue(); }
+
+ private:
+  template <typename PromiseType>
+  static void Resume(void* waiter) {
+    auto* self = static_cast<SharedFutureAwaiter*>(
+        static_cast<SharedFutureWaiter*>(waiter));
+    auto handle =
+        std::coroutine_handle<PromiseType>::from_address(self->handle_.address());
+    handle.promise().set_waiter(nullptr);
+    handle.promise().RefillInlineResumptionBudget();
+    if (!handle.promise().CanResume()) {
+      // Destroying the frame also destroys this awaiter.
+      handle.destroy();
+      return;
+    }
+    handle.resume();
+  }
+
+  template <typename PromiseType>
+  static void Destroy(void* waiter) {
+    auto* self = static_cast<SharedFutureAwaiter*>(
+        static_cast<SharedFutureWaiter*>(waiter));
+    std::coroutine_handle<PromiseType>::from_address(self->handle_.address())
+        .destroy();
+  }
+
+  // Keeps the value alive for the duration of the `co_await` expression.
+  scoped_refptr<SharedFutureState<T>> state_;
+  std::coroutine_handle<> handle_;
+};
+
+}  // namespace internal
+
+// A copyable handle to the value of a future, for any number of consumers on
+// the future's sequence. The value is stored once, in state shared by all
+// copies, and each consumer receives a const reference to it rather than a
+// copy of its own:
+//
+//   SharedFuture<Manifest> manifest = FetchManifest().Share();
+//   for (Component* component : components) {
+//     component->Configure(manifest);
+//   }
+//
+//   Future<void> Component::Configure(SharedFuture<Manifest> manifest) {
+//     const Manifest& value = co_await manifest;
+//     ...
+//   }
+//
+// Coroutines suspended on a pending `SharedFuture` are linked into the shared
+// state, and callbacks of up to `internal::kFutureContinuationInlineSize`
+// bytes are stored inline, so the state itself is the only allocation
+// besides the callbacks' vector. The state waits for the value once shared,
+// even if every copy is dropped. If the source's promise is destroyed
+// without a value, waiting coroutines are destroyed and callbacks dropped, as
+// with a `Future`.
+template <typename T>
+class SharedFuture {
+ public:
+  using ValueType = T;
+
+  // Default-constructed shared futures are inactive.
+  SharedFuture() = default;
+
+  explicit SharedFuture(Future<T> future)
+      : state_(MakeRefCounted<internal::SharedFutureState<T>>(
+            std::move(future))) {
+    state_->Start();
+  }
+
+  SharedFuture(const SharedFuture&) = default;
+  SharedFuture& operator=(const SharedFuture&) = default;
+  SharedFuture(SharedFuture&&) = default;
+  SharedFuture& operator=(SharedFuture&&) = default;
+  ~SharedFuture() = default;
+
+  bool is_ready() const { return state_ && state_->is_ready(); }
+
+  // Returns true if the source's promise was destroyed without a value, so
+  // that the shared future will never be ready.
+  bool is_broken() const { return state_ && state_->is_broken(); }
+
+  // Returns the value. It is an error to call this method when the shared
+  // future is not ready. The reference is valid as long as any copy of the
+  // shared future is alive.
+  const T& GetValueSynchronously() const {
+    CHECK(is_ready());
+    return state_->GetValue();
+  }
+
+  // Attaches a callback that runs with a reference to the value, like
+  // `Future::AndThen`: once the value is available, or in a future turn if
+  // it already is. Unlike `Future::AndThen`, any number of callbacks may be
+  // attached, and the shared future stays active.
+  template <typename F>
+    requires(std::is_invocable_v<std::decay_t<F>, const T&>)
+  void AndThen(F&& callback) const {
+    CHECK(state_);
+    state_->AddCallback(typename internal::SharedFutureState<T>::Callback(
+        std::forward<F>(callback)));
+  }
+
+ private:
+  template <typename U>
+  friend class internal::FuturePromiseTypeBase;
+
+  scoped_refptr<internal::SharedFutureState<T>> state_;
+};
+
+// `SharedFuture<void>` accepts callbacks that take no arguments.
+template <>
+class SharedFuture<void> : public SharedFuture<VoidFutureValue> {
+ public:
+  using ValueType = void;
+
+  SharedFuture() = default;
+  explicit SharedFuture(Future<void> future)
+      : SharedFuture<VoidFutureValue>(std::move(future)) {}
+
+  template <typename F>
+    requires(std::is_invocable_v<std::decay_t<F>>)
+  void AndThen(F&& callback) const {
+    SharedFuture<VoidFutureValue>::AndThen(
+        [callback = std::forward<F>(callback)](const VoidFutureValue&) mutable {
+          std::invoke(std::move(callback));
+        });
+  }
+};
+
+template <typename T>
+SharedFuture<T> Future<T>::Share() && {
+  return SharedFuture<T>(std::move(*this));
+}
+
+inline SharedFuture<void> Future<void>::Share() && {
+  return SharedFuture<void>(std::move(*this));
+}
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_SHARED_FUTURE_H_
@@ -0,0 +1,130 @@
+// Checks that every waiter on a `SharedFuture` receives the one stored value,
+// and that breaking the source's promise destroys waiting coroutines and drops
+// callbacks.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/shared_future.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+
+namespace base {
+namespace {
+
+// Records the values that waiters receive, and how many waiting coroutines
+// have finished or been destroyed.
+class Observer {
+ public:
+  WeakPtr<Observer> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  std::vector<const std::string*> seen;
+  int destroyed = 0;
+
+ private:
+  WeakPtrFactory<Observer> weak_factory_{this};
+};
+
+// Counts its destruction, to tell whether a coroutine frame holding it was
+// destroyed.
+class DestructionCounter {
+ public:
+  explicit DestructionCounter(int* count) : count_(count) {}
+  ~DestructionCounter() { ++*count_; }
+
+ private:
+  int* const count_;
+};
+
+Future<void> AwaitShared(Observer& observer,
+                         SharedFuture<std::string> shared) {
+  DestructionCounter counter(&observer.destroyed);
+  const std::string& value = co_await shared;
+  observer.seen.push_back(&value);
+}
+
+void TestWaitersShareOneValue() {
+  SingleThreadTaskExecutor executor;
+  Promise<std::string> promise;
+  SharedFuture<std::string> shared = promise.GetFuture().Share();
+  Observer observer;
+  for (int i = 0; i < 3; ++i) {
+    AwaitShared(observer, shared);
+  }
+  for (int i = 0; i < 2; ++i) {
+    shared.AndThen([&observer](const std::string& value) {
+      observer.seen.push_back(&value);
+    });
+  }
+  CHECK(!shared.is_ready());
+  promise.SetValue("manifest");
+  RunLoop().RunUntilIdle();
+  CHECK(shared.is_ready());
+  CHECK(observer.seen.size() == 5);
+  for (const std::string* value : observer.seen) {
+    CHECK(value == &shared.GetValueSynchronously());
+  }
+  CHECK(*observer.seen[0] == "manifest");
+  CHECK(observer.destroyed == 3);
+}
+
+// Waiters added once the value is available receive it too.
+void TestLateWaitersReceiveValue() {
+  SingleThreadTaskExecutor executor;
+  Promise<std::string> promise;
+  SharedFuture<std::string> shared = promise.GetFuture().Share();
+  promise.SetValue("manifest");
+  RunLoop().RunUntilIdle();
+  Observer observer;
+  AwaitShared(observer, shared);
+  shared.AndThen([&observer](const std::string& value) {
+    observer.seen.push_back(&value);
+  });
+  RunLoop().RunUntilIdle();
+  CHECK(observer.seen.size() == 2);
+  CHECK(observer.seen[0] == &shared.GetValueSynchronously());
+  CHECK(observer.seen[1] == &shared.GetValueSynchronously());
+}
+
+void TestBrokenSourceReleasesWaiters() {
+  SingleThreadTaskExecutor executor;
+  Observer observer;
+  bool callback_ran = false;
+  SharedFuture<std::string> shared;
+  {
+    Promise<std::string> promise;
+    shared = promise.GetFuture().Share();
+    AwaitShared(observer, shared);
+    AwaitShared(observer, shared);
+    shared.AndThen(
+        [&callback_ran](const std::string&) { callback_ran = true; });
+  }
+  RunLoop().RunUntilIdle();
+  CHECK(shared.is_broken());
+  CHECK(!shared.is_ready());
+  CHECK(observer.destroyed == 2);
+  CHECK(observer.seen.empty());
+  CHECK(!callback_ran);
+  // Waiters arriving after the break are released at once.
+  AwaitShared(observer, shared);
+  CHECK(observer.destroyed == 3);
+  CHECK(observer.seen.empty());
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestWaitersShareOneValue();
+  base::TestLateWaitersReceiveValue();
+  base::TestBrokenSourceReleasesWaiters();
+  return 0;
+}
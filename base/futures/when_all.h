@@ -0,0 +1,187 @@
+#ifndef BASE_FUTURES_WHEN_ALL_H_
+#define BASE_FUTURES_WHEN_ALL_H_
+
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/futures/future.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+
+namespace base {
+
+namespace internal {
+
+// The state shared by the continuations of a `WhenAll` over a fixed set of
+// futures: one results buffer, one count of pending futures, and the promise
+// for the combined value.
+template <typename... Ts>
+class WhenAllTupleState : public RefCounted<WhenAllTupleState<Ts...>> {
+ public:
+  using ResultType = std::tuple<Ts...>;
+
+  explicit WhenAllTupleState(Promise<ResultType> promise)
+      : promise_(std::move(promise)) {}
+
+  template <size_t I>
+  void SetResult(std::tuple_element_t<I, ResultType> value) {
+    std::get<I>(results_).emplace(std::move(value));
+    if (--remaining_ == 0) {
+      promise_.SetValueWithSideEffects(std::apply(
+          [](std::optional<Ts>&... results) {
+            return ResultType(std::move(*results)...);
+          },
+          results_));
+    }
+  }
+
+ private:
+  friend class RefCounted<WhenAllTupleState>;
+
+  ~WhenAllTupleState() = default;
+
+  Promise<ResultType> promise_;
+  std::tuple<std::optional<Ts>...> results_;
+  size_t remaining_ = sizeof...(Ts);
+};
+
+// As above, for a `WhenAll` over a vector of futures. Results are written
+// straight into the output vector when `T` is default-constructible.
+template <typename T>
+class WhenAllVectorState : public RefCounted<WhenAllVectorState<T>> {
+ public:
+  using ResultType = std::vector<T>;
+
+  WhenAllVectorState(Promise<ResultType> promise, size_t size)
+      : promise_(std::move(promise)), results_(size), remaining_(size) {}
+
+  void SetResult(size_t index, T value) {
+    results_[index] = std::move(value);
+    if (--remaining_ > 0) {
+      return;
+    }
+    if constexpr (kStoresValuesDirectly) {
+      promise_.SetValueWithSideEffects(std::move(results_));
+    } else {
+      ResultType values;
+      values.reserve(results_.size());
+      for (std::optional<T>& result : results_) {
+        values.push_back(std::move(*result));
+      }
+      promise_.SetValueWithSideEffects(std::move(values));
+    }
+  }
+
+ private:
+  friend class RefCounted<WhenAllVectorState>;
+
+  static constexpr bool kStoresValuesDirectly =
+      std::is_default_constructible_v<T>;
+
+  ~WhenAllVectorState() = default;
+
+  Promise<ResultType> promise_;
+  std::conditional_t<kStoresValuesDirectly,
+                     std::vector<T>,
+                     std::vector<std::optional<T>>>
+      results_;
+  size_t remaining_;
+};
+
+// As above, for a vector of `Future<void>`, which needs no results buffer.
+class WhenAllVoidState : public RefCounted<WhenAllVoidState> {
+ public:
+  WhenAllVoidState(Promise<void> promise, size_t size)
+      : promise_(std::move(promise)), remaining_(size) {}
+
+  void SetResult() {
+    if (--remaining_ == 0) {
+      promise_.SetValueWithSideEffects();
+    }
+  }
+
+ private:
+  friend class RefCounted<WhenAllVoidState>;
+
+  ~WhenAllVoidState() = default;
+
+  Promise<void> promise_;
+  size_t remaining_;
+};
+
+}  // namespace internal
+
+// Returns a future for the values of all of `futures`, which becomes
+// available once all of them are. The values of `Future<void>` arguments are
+// represented by `VoidFutureValue`. If any of `futures` never resolves,
+// neither does the returned future.
+//
+// The combined future costs a single allocation for its shared state,
+// however many futures there are; each input future's continuation is stored
+// inline.
+template <typename... Ts>
+Future<std::tuple<internal::FutureStorageType<Ts>...>> WhenAll(
+    Future<Ts>... futures) {
+  using State = internal::WhenAllTupleState<internal::FutureStorageType<Ts>...>;
+  using ResultType = typename State::ResultType;
+  if constexpr (sizeof...(Ts) == 0) {
+    return MakeReadyFuture(ResultType());
+  } else {
+    Promise<ResultType> promise;
+    Future<ResultType> future = promise.GetFuture();
+    scoped_refptr<State> state = MakeRefCounted<State>(std::move(promise));
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+      (static_cast<Future<internal::FutureStorageType<Ts>>&&>(futures).AndThen(
+           [state](internal::FutureStorageType<Ts> value) {
+             state->template SetResult<Is>(std::move(value));
+           }),
+       ...);
+    }(std::index_sequence_for<Ts...>());
+    return future;
+  }
+}
+
+// Returns a future for the values of all of `futures`, in order, which
+// becomes available once all of them are. If any of `futures` never
+// resolves, neither does the returned future.
+template <typename T>
+Future<std::vector<T>> WhenAll(std::vector<Future<T>> futures) {
+  using State = internal::WhenAllVectorState<T>;
+  if (futures.empty()) {
+    return MakeReadyFuture(std::vector<T>());
+  }
+  Promise<std::vector<T>> promise;
+  Future<std::vector<T>> future = promise.GetFuture();
+  scoped_refptr<State> state =
+      MakeRefCounted<State>(std::move(promise), futures.size());
+  for (size_t i = 0; i < futures.size(); ++i) {
+    std::move(futures[i]).AndThen([state, i](T value) {
+      state->SetResult(i, std::move(value));
+    });
+  }
+  return future;
+}
+
+// Returns a future that becomes available once all of `futures` are.
+inline Future<void> WhenAll(std::vector<Future<void>> futures) {
+  if (futures.empty()) {
+    return MakeReadyFuture();
+  }
+  Promise<void> promise;
+  Future<void> future = promise.GetFuture();
+  scoped_refptr<internal::WhenAllVoidState> state =
+      MakeRefCounted<internal::WhenAllVoidState>(std::move(promise),
+                                                 futures.size());
+  for (Future<void>& input : futures) {
+    std::move(input).AndThen([state] { state->SetResult(); });
+  }
+  return future;
+}
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_WHEN_ALL_H_
@@ -0,0 +1,100 @@
+// Checks that `WhenAll` resolves with every value, in the order of its
+// arguments, once the last of them arrives.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/when_all.h"
+
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+
+namespace base {
+namespace {
+
+void TestTupleResolvesOnceAllValuesArrive() {
+  SingleThreadTaskExecutor executor;
+  Promise<int> first;
+  Promise<std::string> second;
+  Promise<void> third;
+  std::optional<std::tuple<int, std::string, VoidFutureValue>> result;
+  WhenAll(first.GetFuture(), second.GetFuture(), third.GetFuture())
+      .AndThen([&result](std::tuple<int, std::string, VoidFutureValue> values) {
+        result = std::move(values);
+      });
+  second.SetValue("two");
+  third.SetValue();
+  RunLoop().RunUntilIdle();
+  CHECK(!result);
+  first.SetValue(1);
+  RunLoop().RunUntilIdle();
+  CHECK(result);
+  CHECK(std::get<0>(*result) == 1);
+  CHECK(std::get<1>(*result) == "two");
+}
+
+void TestVectorKeepsArgumentOrder() {
+  SingleThreadTaskExecutor executor;
+  std::vector<Promise<int>> promises(4);
+  std::vector<Future<int>> futures;
+  for (Promise<int>& promise : promises) {
+    futures.push_back(promise.GetFuture());
+  }
+  std::optional<std::vector<int>> result;
+  WhenAll(std::move(futures)).AndThen([&result](std::vector<int> values) {
+    result = std::move(values);
+  });
+  // Resolved in reverse, the values still come back in the inputs' order.
+  for (size_t i = promises.size(); i-- > 0;) {
+    promises[i].SetValue(static_cast<int>(i) * 10);
+  }
+  RunLoop().RunUntilIdle();
+  CHECK(result == std::vector<int>({0, 10, 20, 30}));
+}
+
+void TestVectorOfVoidFutures() {
+  SingleThreadTaskExecutor executor;
+  std::vector<Promise<void>> promises(3);
+  std::vector<Future<void>> futures;
+  for (Promise<void>& promise : promises) {
+    futures.push_back(promise.GetFuture());
+  }
+  bool resolved = false;
+  WhenAll(std::move(futures)).AndThen([&resolved] { resolved = true; });
+  promises[0].SetValue();
+  promises[2].SetValue();
+  RunLoop().RunUntilIdle();
+  CHECK(!resolved);
+  promises[1].SetValue();
+  RunLoop().RunUntilIdle();
+  CHECK(resolved);
+}
+
+void TestEmptyVectorResolvesAtOnce() {
+  SingleThreadTaskExecutor executor;
+  std::optional<std::vector<int>> result;
+  WhenAll(std::vector<Future<int>>())
+      .AndThen(
+          [&result](std::vector<int> values) { result = std::move(values); });
+  RunLoop().RunUntilIdle();
+  CHECK(result && result->empty());
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestTupleResolvesOnceAllValuesArrive();
+  base::TestVectorKeepsArgumentOrder();
+  base::TestVectorOfVoidFutures();
+  base::TestEmptyVectorResolvesAtOnce();
+  return 0;
+}
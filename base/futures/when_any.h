@@ -0,0 +1,193 @@
+#ifndef BASE_FUTURES_WHEN_ANY_H_
+#define BASE_FUTURES_WHEN_ANY_H_
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/futures/promise_observer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+
+namespace base {
+
+namespace internal {
+
+// The state shared by the continuations of a `WhenAny` over a fixed set of
+// futures. It keeps the input futures watching their promises, so that the
+// first value to arrive can abandon the rest.
+template <typename... Ts>
+class WhenAnyTupleState : public RefCounted<WhenAnyTupleState<Ts...>>,
+                          public PromiseObserver {
+ public:
+  using ResultType = std::variant<Ts...>;
+
+  WhenAnyTupleState(Promise<ResultType> promise, Future<Ts>... futures)
+      : promise_(std::move(promise)), futures_(std::move(futures)...) {
+    FutureAccess::SetObserver(promise_, this);
+  }
+
+  // Must be called once, after construction, to attach the continuations.
+  void Watch() {
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+      (FutureAccess::Watch(
+           std::get<Is>(futures_),
+           FutureContinuation<Ts>(
+               [state = scoped_refptr<WhenAnyTupleState>(this)](Ts value) {
+                 state->template SetResult<Is>(std::move(value));
+               })),
+       ...);
+    }(std::index_sequence_for<Ts...>());
+  }
+
+  template <size_t I>
+  void SetResult(std::tuple_element_t<I, std::tuple<Ts...>> value) {
+    if (settled_) {
+      return;
+    }
+    // The continuation running this holds a reference, so the state outlives
+    // the abandoned futures' references.
+    AbandonFutures();
+    promise_.SetValueWithSideEffects(
+        ResultType(std::in_place_index<I>, std::move(value)));
+  }
+
+ private:
+  friend class RefCounted<WhenAnyTupleState>;
+
+  ~WhenAnyTupleState() = default;
+
+  // PromiseObserver:
+  void OnFutureDropped(bool abandoned) override {
+    if (abandoned) {
+      scoped_refptr<WhenAnyTupleState> self(this);
+      AbandonFutures();
+    }
+  }
+
+  void AbandonFutures() {
+    settled_ = true;
+    std::apply(
+        [](Future<Ts>&... futures) { (FutureAccess::Abandon(futures), ...); },
+        futures_);
+  }
+
+  Promise<ResultType> promise_;
+  std::tuple<Future<Ts>...> futures_;
+  bool settled_ = false;
+};
+
+// As above, for a `WhenAny` over a vector of futures.
+template <typename T>
+class WhenAnyVectorState : public RefCounted<WhenAnyVectorState<T>>,
+                           public PromiseObserver {
+ public:
+  using ResultType = std::pair<size_t, T>;
+
+  WhenAnyVectorState(Promise<ResultType> promise,
+                     std::vector<Future<T>> futures)
+      : promise_(std::move(promise)), futures_(std::move(futures)) {
+    FutureAccess::SetObserver(promise_, this);
+  }
+
+  // Must be called once, after construction, to attach the continuations.
+  void Watch() {
+    for (size_t i = 0; i < futures_.size(); ++i) {
+      FutureAccess::Watch(
+          futures_[i],
+          FutureContinuation<T>(
+              [state = scoped_refptr<WhenAnyVectorState>(this), i](T value) {
+                state->SetResult(i, std::move(value));
+              }));
+    }
+  }
+
+  void SetResult(size_t index, T value) {
+    if (settled_) {
+      return;
+    }
+    AbandonFutures();
+    promise_.SetValueWithSideEffects(ResultType(index, std::move(value)));
+  }
+
+ private:
+  friend class RefCounted<WhenAnyVectorState>;
+
+  ~WhenAnyVectorState() = default;
+
+  // PromiseObserver:
+  void OnFutureDropped(bool abandoned) override {
+    if (abandoned) {
+      scoped_refptr<WhenAnyVectorState> self(this);
+      AbandonFutures();
+    }
+  }
+
+  void AbandonFutures() {
+    settled_ = true;
+    for (Future<T>& future : futures_) {
+      FutureAccess::Abandon(future);
+    }
+  }
+
+  Promise<ResultType> promise_;
+  std::vector<Future<T>> futures_;
+  bool settled_ = false;
+};
+
+}  // namespace internal
+
+// Returns a future for the value of whichever of `futures` becomes available
+// first, as the alternative of the variant at its position. The values of
+// `Future<void>` arguments are represented by `VoidFutureValue`. If none of
+// `futures` ever resolves, neither does the returned future.
+//
+// Once one future resolves, the others are abandoned: their continuations
+// are released at once rather than when their promises are eventually
+// destroyed, and a coroutine suspended on producing one of them is destroyed
+// along with its frame, recursively abandoning whatever it was awaiting.
+// Abandoning the returned future itself does the same for all of `futures`.
+template <typename... Ts>
+  requires(sizeof...(Ts) > 0)
+Future<std::variant<internal::FutureStorageType<Ts>...>> WhenAny(
+    Future<Ts>... futures) {
+  using State = internal::WhenAnyTupleState<internal::FutureStorageType<Ts>...>;
+  using ResultType = typename State::ResultType;
+  Promise<ResultType> promise;
+  Future<ResultType> future = promise.GetFuture();
+  scoped_refptr<State> state = MakeRefCounted<State>(
+      std::move(promise),
+      static_cast<Future<internal::FutureStorageType<Ts>>&&>(futures)...);
+  state->Watch();
+  return future;
+}
+
+// Returns a future for the position and value of whichever of `futures`
+// becomes available first, abandoning the others as above. `futures` must not
+// be empty.
+template <typename T>
+Future<std::pair<size_t, internal::FutureStorageType<T>>> WhenAny(
+    std::vector<Future<T>> futures) {
+  using Storage = internal::FutureStorageType<T>;
+  using State = internal::WhenAnyVectorState<Storage>;
+  CHECK(!futures.empty());
+  Promise<std::pair<size_t, Storage>> promise;
+  Future<std::pair<size_t, Storage>> future = promise.GetFuture();
+  std::vector<Future<Storage>> inputs;
+  inputs.reserve(futures.size());
+  for (Future<T>& input : futures) {
+    inputs.push_back(std::move(input));
+  }
+  scoped_refptr<State> state =
+      MakeRefCounted<State>(std::move(promise), std::move(inputs));
+  state->Watch();
+  return future;
+}
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_WHEN_ANY_H_
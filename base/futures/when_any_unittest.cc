@@ -0,0 +1,88 @@
+// Checks that `WhenAny` resolves with the first value to arrive, at the
+// position of its future, and abandons the others.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/when_any.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+
+namespace base {
+namespace {
+
+Future<int> AwaitAndIncrement(Future<int> reply) {
+  int value = co_await std::move(reply);
+  co_return value + 1;
+}
+
+void TestTupleResolvesWithFirstValue() {
+  SingleThreadTaskExecutor executor;
+  Promise<int> first;
+  Promise<std::string> second;
+  Promise<void> third;
+  using Result = std::variant<int, std::string, VoidFutureValue>;
+  std::optional<Result> result;
+  WhenAny(first.GetFuture(), second.GetFuture(), third.GetFuture())
+      .AndThen([&result](Result value) { result = std::move(value); });
+  second.SetValue("second");
+  RunLoop().RunUntilIdle();
+  CHECK(result && result->index() == 1);
+  CHECK(std::get<1>(*result) == "second");
+  CHECK(first.IsAbandoned());
+  CHECK(third.IsAbandoned());
+}
+
+void TestVectorReportsWinnerIndex() {
+  SingleThreadTaskExecutor executor;
+  std::vector<Promise<int>> promises(4);
+  std::vector<Future<int>> futures;
+  for (Promise<int>& promise : promises) {
+    futures.push_back(promise.GetFuture());
+  }
+  std::optional<std::pair<size_t, int>> result;
+  WhenAny(std::move(futures)).AndThen([&result](std::pair<size_t, int> value) {
+    result = value;
+  });
+  promises[2].SetValue(20);
+  // A later value is ignored.
+  promises[1].SetValue(10);
+  RunLoop().RunUntilIdle();
+  CHECK(result == std::make_pair(size_t{2}, 20));
+  CHECK(promises[0].IsAbandoned());
+  CHECK(promises[3].IsAbandoned());
+}
+
+// A losing coroutine is destroyed, which in turn abandons what it awaited.
+void TestLosingCoroutineIsDestroyed() {
+  SingleThreadTaskExecutor executor;
+  Promise<int> slow;
+  Promise<int> fast;
+  std::optional<std::variant<int, int>> result;
+  WhenAny(AwaitAndIncrement(slow.GetFuture()), fast.GetFuture())
+      .AndThen([&result](std::variant<int, int> value) { result = value; });
+  CHECK(!slow.IsAbandoned());
+  fast.SetValue(1);
+  RunLoop().RunUntilIdle();
+  CHECK(result && result->index() == 1);
+  CHECK(slow.IsAbandoned());
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestTupleResolvesWithFirstValue();
+  base::TestVectorReportsWinnerIndex();
+  base::TestLosingCoroutineIsDestroyed();
+  return 0;
+}
@@ -0,0 +1,138 @@
+#ifndef BASE_FUTURES_WITH_TIMEOUT_H_
+#define BASE_FUTURES_WITH_TIMEOUT_H_
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "base/futures/future.h"
+#include "base/futures/promise_observer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/timer_wheel.h"
+#include "base/time/time.h"
+
+namespace base {
+
+namespace internal {
+
+// `std::optional<T>`, or `bool` for `Future<void>`, as with `AwaitOptional`.
+template <typename T>
+using WithTimeoutResultType =
+    std::conditional_t<std::is_same_v<T, VoidFutureValue>,
+                       bool,
+                       std::optional<T>>;
+
+template <typename T>
+WithTimeoutResultType<T> MakeWithTimeoutResult(T value) {
+  if constexpr (std::is_same_v<T, VoidFutureValue>) {
+    return true;
+  } else {
+    return std::optional<T>(std::move(value));
+  }
+}
+
+// The state of a `WithTimeout`, which is also its timer. The input future
+// watches its promise, and the continuation holds the only reference to the
+// state, so that the state lives exactly as long as a value may still arrive.
+template <typename T>
+class WithTimeoutState final : public RefCounted<WithTimeoutState<T>>,
+                               public TimerWheel::Timer,
+                               public PromiseObserver {
+ public:
+  using ResultType = WithTimeoutResultType<T>;
+
+  WithTimeoutState(Promise<ResultType> promise, Future<T> future)
+      : promise_(std::move(promise)), future_(std::move(future)) {
+    FutureAccess::SetObserver(promise_, this);
+  }
+
+  // Must be called once, after construction, to attach the continuation and
+  // start the timer.
+  void Start(TimeDelta timeout) {
+    FutureAccess::Watch(
+        future_, FutureContinuation<T>(
+                     [state = scoped_refptr<WithTimeoutState>(this)](T value) {
+                       state->OnValue(std::move(value));
+                     }));
+    TimerWheel::GetForCurrentSequence().Schedule(*this, timeout);
+  }
+
+ private:
+  friend class RefCounted<WithTimeoutState>;
+
+  ~WithTimeoutState() override = default;
+
+  void OnValue(T value) {
+    if (settled_) {
+      return;
+    }
+    settled_ = true;
+    Cancel();
+    promise_.SetValueWithSideEffects(MakeWithTimeoutResult(std::move(value)));
+  }
+
+  // TimerWheel::Timer:
+  void OnTimerFired() override {
+    // Abandoning the input releases the continuation's reference.
+    scoped_refptr<WithTimeoutState> self(this);
+    settled_ = true;
+    FutureAccess::Abandon(future_);
+    // The timer fired before the input resolved, so the timeout wins.
+    promise_.SetValueWithSideEffects(ResultType());
+  }
+
+  // PromiseObserver:
+  void OnFutureDropped(bool abandoned) override {
+    scoped_refptr<WithTimeoutState> self(this);
+    settled_ = true;
+    Cancel();
+    // Pass on how the result was given up.
+    if (abandoned) {
+      FutureAccess::Abandon(future_);
+    } else {
+      Future<T> dropped_future = std::move(future_);
+    }
+  }
+
+  Promise<ResultType> promise_;
+  Future<T> future_;
+  bool settled_ = false;
+};
+
+}  // namespace internal
+
+// Returns a future for the value of `future`, or for `std::nullopt` if it is
+// not available within `timeout`, give or take the slack of the sequence's
+// `TimerWheel`. For `Future<void>` the result is whether it resolved in
+// time. On expiry, `future` is abandoned like the losers of `WhenAny`. When
+// `future` wins, its timer is unlinked from the wheel at once, so a timeout
+// that does not expire costs one allocation for the shared state, and
+// nothing at all if `future` is already resolved. If the promise of `future`
+// is destroyed without a value, so is the returned future's.
+template <typename T>
+Future<internal::WithTimeoutResultType<internal::FutureStorageType<T>>>
+WithTimeout(Future<T> future, TimeDelta timeout) {
+  using Storage = internal::FutureStorageType<T>;
+  using State = internal::WithTimeoutState<Storage>;
+  using ResultType = typename State::ResultType;
+  Future<Storage> input = static_cast<Future<Storage>&&>(future);
+  if (input.is_ready()) {
+    return MakeReadyFuture(internal::MakeWithTimeoutResult(
+        std::move(input).GetValueSynchronously()));
+  }
+  if (!timeout.is_positive()) {
+    internal::FutureAccess::Abandon(input);
+    return MakeReadyFuture(ResultType());
+  }
+  Promise<ResultType> promise;
+  Future<ResultType> result = promise.GetFuture();
+  scoped_refptr<State> state =
+      MakeRefCounted<State>(std::move(promise), std::move(input));
+  state->Start(timeout);
+  return result;
+}
+
+}  // namespace base
+
+#endif  // BASE_FUTURES_WITH_TIMEOUT_H_
@@ -0,0 +1,97 @@
+// Checks that `WithTimeout` resolves with the input's value when it arrives in
+// time, and otherwise with no value, abandoning the input.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/futures/with_timeout.h"
+
+#include <optional>
+#include <utility>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/task/timer_wheel.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace {
+
+void TestValueBeforeTimeout() {
+  SingleThreadTaskExecutor executor;
+  Promise<int> reply;
+  std::optional<std::optional<int>> result;
+  WithTimeout(reply.GetFuture(), Seconds(60))
+      .AndThen([&result](std::optional<int> value) { result = value; });
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 1);
+  reply.SetValue(7);
+  RunLoop().RunUntilIdle();
+  CHECK(result && *result == 7);
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 0);
+}
+
+void TestExpiryResolvesWithNullopt() {
+  SingleThreadTaskExecutor executor;
+  Promise<int> reply;
+  RunLoop run_loop;
+  std::optional<std::optional<int>> result;
+  WithTimeout(reply.GetFuture(), Milliseconds(10))
+      .AndThen([&](std::optional<int> value) {
+        result = value;
+        run_loop.Quit();
+      });
+  run_loop.Run();
+  CHECK(result && !*result);
+  CHECK(reply.IsAbandoned());
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 0);
+}
+
+void TestVoidFutureResolvedInTime() {
+  SingleThreadTaskExecutor executor;
+  Promise<void> done;
+  std::optional<bool> result;
+  WithTimeout(done.GetFuture(), Seconds(60))
+      .AndThen([&result](bool resolved) { result = resolved; });
+  done.SetValue();
+  RunLoop().RunUntilIdle();
+  CHECK(result == true);
+}
+
+void TestVoidFutureTimedOut() {
+  SingleThreadTaskExecutor executor;
+  Promise<void> done;
+  RunLoop run_loop;
+  std::optional<bool> result;
+  WithTimeout(done.GetFuture(), Milliseconds(10)).AndThen([&](bool resolved) {
+    result = resolved;
+    run_loop.Quit();
+  });
+  run_loop.Run();
+  CHECK(result == false);
+  CHECK(done.IsAbandoned());
+}
+
+// An input that is ready already needs no timer.
+void TestReadyInputStartsNoTimer() {
+  SingleThreadTaskExecutor executor;
+  std::optional<std::optional<int>> result;
+  WithTimeout(MakeReadyFuture(3), Seconds(60))
+      .AndThen([&result](std::optional<int> value) { result = value; });
+  CHECK(TimerWheel::GetForCurrentSequence().GetNumTimers() == 0);
+  RunLoop().RunUntilIdle();
+  CHECK(result && *result == 3);
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestValueBeforeTimeout();
+  base::TestExpiryResolvesWithNullopt();
+  base::TestVoidFutureResolvedInTime();
+  base::TestVoidFutureTimedOut();
+  base::TestReadyInputStartsNoTimer();
+  return 0;
+}
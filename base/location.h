@@ -0,0 +1,33 @@
+#ifndef BASE_LOCATION_H_
+#define BASE_LOCATION_H_
+
+namespace base {
+
+// Records the source position at which a task was posted.
+class Location {
+ public:
+  constexpr Location() = default;
+  constexpr Location(const char* function_name, const char* file_name, int line)
+      : function_name_(function_name), file_name_(file_name), line_(line) {}
+
+  static constexpr Location Current(const char* function_name,
+                                    const char* file_name,
+                                    int line) {
+    return Location(function_name, file_name, line);
+  }
+
+  const char* function_name() const { return function_name_; }
+  const char* file_name() const { return file_name_; }
+  int line_number() const { return line_; }
+
+ private:
+  const char* function_name_ = nullptr;
+  const char* file_name_ = nullptr;
+  int line_ = -1;
+};
+
+}  // namespace base
+
+#define FROM_HERE ::base::Location::Current(__func__, __FILE__, __LINE__)
+
+#endif  // BASE_LOCATION_H_
@@ -0,0 +1,75 @@
+#ifndef BASE_MEMORY_REF_COUNTED_H_
+#define BASE_MEMORY_REF_COUNTED_H_
+
+#include <atomic>
+#include <utility>
+
+#include "base/check.h"
+#include "base/memory/scoped_refptr.h"
+
+namespace base {
+
+// Base class for reference-counted objects that are only referenced from a
+// single sequence. Derived classes should make their destructor private or
+// protected and befriend `RefCounted<T>`.
+template <class T>
+class RefCounted {
+ public:
+  RefCounted(const RefCounted&) = delete;
+  RefCounted& operator=(const RefCounted&) = delete;
+
+  void AddRef() const { ++ref_count_; }
+
+  void Release() const {
+    DCHECK(ref_count_ > 0);
+    if (--ref_count_ == 0) {
+      delete static_cast<const T*>(this);
+    }
+  }
+
+  bool HasOneRef() const { return ref_count_ == 1; }
+
+ protected:
+  RefCounted() = default;
+  ~RefCounted() = default;
+
+ private:
+  mutable int ref_count_ = 0;
+};
+
+// Like `RefCounted<T>`, but the reference count may be manipulated from any
+// thread.
+template <class T>
+class RefCountedThreadSafe {
+ public:
+  RefCountedThreadSafe(const RefCountedThreadSafe&) = delete;
+  RefCountedThreadSafe& operator=(const RefCountedThreadSafe&) = delete;
+
+  void AddRef() const { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  void Release() const {
+    if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete static_cast<const T*>(this);
+    }
+  }
+
+  bool HasOneRef() const {
+    return ref_count_.load(std::memory_order_acquire) == 1;
+  }
+
+ protected:
+  RefCountedThreadSafe() = default;
+  ~RefCountedThreadSafe() = default;
+
+ private:
+  mutable std::atomic<int> ref_count_{0};
+};
+
+template <typename T, typename... Args>
+scoped_refptr<T> MakeRefCounted(Args&&... args) {
+  return scoped_refptr<T>(new T(std::forward<Args>(args)...));
+}
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_REF_COUNTED_H_
@@ -0,0 +1,79 @@
+#ifndef BASE_MEMORY_SCOPED_REFPTR_H_
+#define BASE_MEMORY_SCOPED_REFPTR_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace base {
+
+// A smart pointer for intrusively reference-counted objects. `T` must provide
+// `AddRef()` and `Release()`, typically by deriving from `RefCounted<T>` or
+// `RefCountedThreadSafe<T>`.
+template <class T>
+class scoped_refptr {
+ public:
+  using element_type = T;
+
+  constexpr scoped_refptr() = default;
+  constexpr scoped_refptr(std::nullptr_t) {}
+
+  scoped_refptr(T* p) : ptr_(p) {
+    if (ptr_) {
+      ptr_->AddRef();
+    }
+  }
+
+  scoped_refptr(const scoped_refptr& r) : scoped_refptr(r.ptr_) {}
+
+  template <typename U>
+    requires std::is_convertible_v<U*, T*>
+  scoped_refptr(const scoped_refptr<U>& r) : scoped_refptr(r.get()) {}
+
+  scoped_refptr(scoped_refptr&& r) noexcept : ptr_(std::exchange(r.ptr_, nullptr)) {}
+
+  template <typename U>
+    requires std::is_convertible_v<U*, T*>
+  scoped_refptr(scoped_refptr<U>&& r) noexcept : ptr_(r.release()) {}
+
+  ~scoped_refptr() {
+    if (ptr_) {
+      ptr_->Release();
+    }
+  }
+
+  scoped_refptr& operator=(std::nullptr_t) {
+    reset();
+    return *this;
+  }
+
+  scoped_refptr& operator=(scoped_refptr r) noexcept {
+    std::swap(ptr_, r.ptr_);
+    return *this;
+  }
+
+  T* get() const { return ptr_; }
+  T& operator*() const { return *ptr_; }
+  T* operator->() const { return ptr_; }
+  explicit operator bool() const { return ptr_ != nullptr; }
+
+  void reset() { scoped_refptr().swap(*this); }
+
+  // Returns the owned pointer without releasing the reference.
+  [[nodiscard]] T* release() { return std::exchange(ptr_, nullptr); }
+
+  void swap(scoped_refptr& r) noexcept { std::swap(ptr_, r.ptr_); }
+
+  template <typename U>
+  bool operator==(const scoped_refptr<U>& rhs) const {
+    return ptr_ == rhs.get();
+  }
+  bool operator==(std::nullptr_t) const { return ptr_ == nullptr; }
+
+ private:
+  T* ptr_ = nullptr;
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SCOPED_REFPTR_H_
@@ -0,0 +1,228 @@
+#ifndef BASE_MEMORY_WEAK_PTR_H_
+#define BASE_MEMORY_WEAK_PTR_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "base/check.h"
+#include "base/memory/ref_counted.h"
+
+namespace base {
+
+template <typename T>
+class WeakPtr;
+
+namespace internal {
+
+class WeakReferenceObserver;
+
+// A reference to a shared validity flag. All weak pointers handed out by one
+// `WeakPtrFactory` share the same flag until the factory is invalidated.
+class WeakReference {
+ public:
+  class Flag : public RefCountedThreadSafe<Flag> {
+   public:
+    Flag() = default;
+
+    // Notifies observers, each of which is removed before it is notified and
+    // may remove others.
+    void Invalidate();
+    bool IsValid() const { return valid_; }
+
+   private:
+    friend class RefCountedThreadSafe<Flag>;
+    friend class WeakReferenceObserver;
+
+    ~Flag() = default;
+
+    bool valid_ = true;
+    // The most recently added observer; observers form a doubly-linked list.
+    WeakReferenceObserver* observers_ = nullptr;
+  };
+
+  WeakReference() = default;
+  explicit WeakReference(const scoped_refptr<Flag>& flag) : flag_(flag) {}
+
+  bool IsValid() const { return flag_ && flag_->IsValid(); }
+  void Reset() { flag_ = nullptr; }
+
+ private:
+  friend class WeakReferenceObserver;
+
+  scoped_refptr<Flag> flag_;
+};
+
+// Notified when a weak reference is invalidated, so that an object holding
+// weak pointers can release itself at once rather than when it next tries to
+// use them. Observers are sequence-bound, like the weak pointers themselves,
+// and keep the observed flag alive.
+class WeakReferenceObserver {
+ public:
+  WeakReferenceObserver() = default;
+  WeakReferenceObserver(const WeakReferenceObserver&) = delete;
+  WeakReferenceObserver& operator=(const WeakReferenceObserver&) = delete;
+
+  // Starts observing the reference held by `weak_ptr`. Returns false, without
+  // observing, if it is already invalid.
+  template <typename T>
+  bool Observe(WeakPtr<T> weak_ptr) {
+    return Observe(std::move(weak_ptr.ref_));
+  }
+
+  void StopObserving() {
+    if (!flag_) {
+      return;
+    }
+    if (prev_) {
+      prev_->next_ = next_;
+    } else {
+      flag_->observers_ = next_;
+    }
+    if (next_) {
+      next_->prev_ = prev_;
+    }
+    flag_ = nullptr;
+    prev_ = nullptr;
+    next_ = nullptr;
+    ref_.Reset();
+  }
+
+  // Called after the observation has stopped. May destroy this observer.
+  virtual void OnWeakReferenceInvalidated() = 0;
+
+ protected:
+  virtual ~WeakReferenceObserver() { StopObserving(); }
+
+ private:
+  bool Observe(WeakReference ref) {
+    StopObserving();
+    if (!ref.IsValid()) {
+      return false;
+    }
+    ref_ = std::move(ref);
+    flag_ = ref_.flag_.get();
+    next_ = flag_->observers_;
+    if (next_) {
+      next_->prev_ = this;
+    }
+    flag_->observers_ = this;
+    return true;
+  }
+
+  // Keeps `flag_` alive while observing it.
+  WeakReference ref_;
+  WeakReference::Flag* flag_ = nullptr;
+  WeakReferenceObserver* prev_ = nullptr;
+  WeakReferenceObserver* next_ = nullptr;
+};
+
+inline void WeakReference::Flag::Invalidate() {
+  valid_ = false;
+  while (WeakReferenceObserver* observer = observers_) {
+    observer->StopObserving();
+    observer->OnWeakReferenceInvalidated();
+  }
+}
+
+// Owns the validity flag. The flag is created lazily, so that objects which
+// never hand out weak pointers do not allocate.
+class WeakReferenceOwner {
+ public:
+  WeakReferenceOwner() = default;
+  WeakReferenceOwner(const WeakReferenceOwner&) = delete;
+  WeakReferenceOwner& operator=(const WeakReferenceOwner&) = delete;
+  ~WeakReferenceOwner() { Invalidate(); }
+
+  WeakReference GetRef() const {
+    if (!flag_) {
+      flag_ = MakeRefCounted<WeakReference::Flag>();
+    }
+    return WeakReference(flag_);
+  }
+
+  bool HasRefs() const { return flag_ && !flag_->HasOneRef(); }
+
+  void Invalidate() {
+    if (flag_) {
+      flag_->Invalidate();
+      flag_ = nullptr;
+    }
+  }
+
+ private:
+  mutable scoped_refptr<WeakReference::Flag> flag_;
+};
+
+}  // namespace internal
+
+// A pointer that becomes null when the `WeakPtrFactory` that produced it is
+// destroyed or invalidated. Weak pointers must be dereferenced and invalidated
+// on the same sequence.
+template <typename T>
+class WeakPtr {
+ public:
+  WeakPtr() = default;
+  WeakPtr(std::nullptr_t) {}
+
+  template <typename U>
+    requires std::is_convertible_v<U*, T*>
+  WeakPtr(const WeakPtr<U>& other) : ref_(other.ref_), ptr_(other.ptr_) {}
+
+  T* get() const { return ref_.IsValid() ? ptr_ : nullptr; }
+
+  T& operator*() const {
+    CHECK(ref_.IsValid());
+    return *ptr_;
+  }
+  T* operator->() const {
+    CHECK(ref_.IsValid());
+    return ptr_;
+  }
+
+  explicit operator bool() const { return get() != nullptr; }
+
+  void reset() {
+    ref_.Reset();
+    ptr_ = nullptr;
+  }
+
+ private:
+  template <typename U>
+  friend class WeakPtr;
+  template <typename U>
+  friend class WeakPtrFactory;
+  friend class internal::WeakReferenceObserver;
+
+  WeakPtr(const internal::WeakReference& ref, T* ptr) : ref_(ref), ptr_(ptr) {}
+
+  internal::WeakReference ref_;
+  T* ptr_ = nullptr;
+};
+
+// Hands out weak pointers to `T`. The factory should be the last member of
+// `T` so that weak pointers are invalidated before any other member is
+// destroyed.
+template <class T>
+class WeakPtrFactory {
+ public:
+  explicit WeakPtrFactory(T* ptr) : ptr_(ptr) {}
+  WeakPtrFactory(const WeakPtrFactory&) = delete;
+  WeakPtrFactory& operator=(const WeakPtrFactory&) = delete;
+  ~WeakPtrFactory() = default;
+
+  WeakPtr<T> GetWeakPtr() const { return WeakPtr<T>(owner_.GetRef(), ptr_); }
+
+  // Invalidates all existing weak pointers.
+  void InvalidateWeakPtrs() { owner_.Invalidate(); }
+
+  bool HasWeakPtrs() const { return owner_.HasRefs(); }
+
+ private:
+  internal::WeakReferenceOwner owner_;
+  T* ptr_;
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_WEAK_PTR_H_
@@ -0,0 +1,54 @@
+#include "base/run_loop.h"
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/location.h"
+#include "base/task/task_queue.h"
+
+namespace base {
+
+RunLoop::RunLoop()
+    : task_queue_(internal::TaskQueue::GetCurrent()),
+      origin_task_runner_(SequencedTaskRunner::GetCurrentDefault()) {
+  CHECK(task_queue_);
+}
+
+RunLoop::~RunLoop() = default;
+
+void RunLoop::Run() {
+  DCHECK(task_queue_->RunsTasksInCurrentSequence());
+  while (!quit_called_) {
+    if (!task_queue_->RunNextTask()) {
+      task_queue_->WaitForWork();
+    }
+  }
+}
+
+void RunLoop::RunUntilIdle() {
+  DCHECK(task_queue_->RunsTasksInCurrentSequence());
+  while (!quit_called_ && task_queue_->RunNextTask()) {
+  }
+}
+
+void RunLoop::Quit() {
+  DCHECK(task_queue_->RunsTasksInCurrentSequence());
+  quit_called_ = true;
+}
+
+OnceClosure RunLoop::QuitClosure() {
+  return BindOnce(
+      [](scoped_refptr<SequencedTaskRunner> task_runner,
+         WeakPtr<RunLoop> run_loop) {
+        if (task_runner->RunsTasksInCurrentSequence()) {
+          if (run_loop) {
+            run_loop->Quit();
+          }
+          return;
+        }
+        task_runner->PostTask(FROM_HERE,
+                              BindOnce(&RunLoop::Quit, std::move(run_loop)));
+      },
+      origin_task_runner_, weak_factory_.GetWeakPtr());
+}
+
+}  // namespace base
@@ -0,0 +1,48 @@
+#ifndef BASE_RUN_LOOP_H_
+#define BASE_RUN_LOOP_H_
+
+#include "base/functional/callback.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+namespace internal {
+class TaskQueue;
+}  // namespace internal
+
+// Runs tasks posted to the current thread's `SingleThreadTaskExecutor`.
+class RunLoop {
+ public:
+  RunLoop();
+  RunLoop(const RunLoop&) = delete;
+  RunLoop& operator=(const RunLoop&) = delete;
+  ~RunLoop();
+
+  // Runs tasks, waiting for new ones as needed, until `Quit()` is called. If
+  // `Quit()` was called before `Run()`, returns immediately.
+  void Run();
+
+  // Runs tasks until none are ready to run. Does not wait for delayed tasks.
+  void RunUntilIdle();
+
+  // Makes `Run()` return after the current task. Must be called on the loop's
+  // sequence.
+  void Quit();
+
+  // Returns a closure that quits this loop. Unlike `Quit()`, the closure may
+  // be run from any sequence.
+  OnceClosure QuitClosure();
+
+ private:
+  scoped_refptr<internal::TaskQueue> task_queue_;
+  scoped_refptr<SequencedTaskRunner> origin_task_runner_;
+  bool quit_called_ = false;
+
+  WeakPtrFactory<RunLoop> weak_factory_{this};
+};
+
+}  // namespace base
+
+#endif  // BASE_RUN_LOOP_H_
@@ -0,0 +1,32 @@
+#include "base/task/current_thread.h"
+
+#include "base/check.h"
+#include "base/task/task_queue.h"
+
+namespace base {
+
+// static
+bool CurrentThread::IsSet() {
+  return internal::TaskQueue::GetCurrent() != nullptr;
+}
+
+// static
+CurrentThread CurrentThread::Get() {
+  internal::TaskQueue* task_queue = internal::TaskQueue::GetCurrent();
+  CHECK(task_queue);
+  return CurrentThread(task_queue);
+}
+
+void CurrentThread::AddTaskObserver(TaskObserver* observer) {
+  task_queue_->AddTaskObserver(observer);
+}
+
+void CurrentThread::RemoveTaskObserver(TaskObserver* observer) {
+  task_queue_->RemoveTaskObserver(observer);
+}
+
+bool CurrentThread::IsRunningTask() const {
+  return task_queue_->IsRunningTask();
+}
+
+}  // namespace base
@@ -0,0 +1,39 @@
+#ifndef BASE_TASK_CURRENT_THREAD_H_
+#define BASE_TASK_CURRENT_THREAD_H_
+
+namespace base {
+
+class TaskObserver;
+
+namespace internal {
+class TaskQueue;
+}  // namespace internal
+
+// A view of the task queue bound to the current thread by a
+// `SingleThreadTaskExecutor`.
+class CurrentThread {
+ public:
+  // Returns true if the current thread has a task queue.
+  static bool IsSet();
+
+  // It is an error to call this when `IsSet()` is false.
+  static CurrentThread Get();
+
+  // Observers are notified around every task run by this thread's queue. An
+  // observer added while a task runs is notified when that task completes.
+  void AddTaskObserver(TaskObserver* observer);
+  void RemoveTaskObserver(TaskObserver* observer);
+
+  // Returns true if a task is currently running on this thread.
+  bool IsRunningTask() const;
+
+ private:
+  explicit CurrentThread(internal::TaskQueue* task_queue)
+      : task_queue_(task_queue) {}
+
+  internal::TaskQueue* task_queue_;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_CURRENT_THREAD_H_
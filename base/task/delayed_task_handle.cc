@@ -0,0 +1,34 @@
+#include "base/task/delayed_task_handle.h"
+
+#include "base/task/task_queue.h"
+
+namespace base {
+
+DelayedTaskHandle::DelayedTaskHandle(DelayedTaskHandle&& other) {
+  if (other.task_queue_) {
+    other.task_queue_->MoveDelayedTaskHandle(other, *this);
+  }
+}
+
+DelayedTaskHandle& DelayedTaskHandle::operator=(DelayedTaskHandle&& other) {
+  if (this != &other) {
+    CancelTask();
+    if (other.task_queue_) {
+      other.task_queue_->MoveDelayedTaskHandle(other, *this);
+    }
+  }
+  return *this;
+}
+
+DelayedTaskHandle::~DelayedTaskHandle() {
+  CancelTask();
+}
+
+void DelayedTaskHandle::CancelTask() {
+  // The task may own this handle, so it must not be used after the call.
+  if (task_queue_) {
+    task_queue_->CancelDelayedTask(*this);
+  }
+}
+
+}  // namespace base
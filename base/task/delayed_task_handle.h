@@ -0,0 +1,48 @@
+#ifndef BASE_TASK_DELAYED_TASK_HANDLE_H_
+#define BASE_TASK_DELAYED_TASK_HANDLE_H_
+
+#include <cstddef>
+
+namespace base {
+
+namespace internal {
+class TaskQueue;
+}  // namespace internal
+
+// Refers to a task posted by `SequencedTaskRunner::PostCancelableDelayedTask`
+// while it waits for its run time. Cancelling the task removes it from the
+// delayed queue and destroys it at once, rather than leaving it to be
+// discarded when it comes due. Handles must be used and destroyed on the
+// sequence that posted the task.
+class DelayedTaskHandle {
+ public:
+  DelayedTaskHandle() = default;
+  DelayedTaskHandle(const DelayedTaskHandle&) = delete;
+  DelayedTaskHandle& operator=(const DelayedTaskHandle&) = delete;
+  DelayedTaskHandle(DelayedTaskHandle&& other);
+  DelayedTaskHandle& operator=(DelayedTaskHandle&& other);
+
+  // Cancels the task, if it is still waiting.
+  ~DelayedTaskHandle();
+
+  // Returns true until the task is cancelled, becomes ready to run, or is
+  // destroyed by the runner's shutdown.
+  bool IsValid() const { return task_queue_ != nullptr; }
+
+  // Destroys the task if it is still waiting, and does nothing otherwise.
+  // The task is destroyed synchronously, so it may own the handle.
+  void CancelTask();
+
+ private:
+  friend class internal::TaskQueue;
+
+  // Set while the task is in `task_queue_`'s delayed queue.
+  internal::TaskQueue* task_queue_ = nullptr;
+  // The task's position in the delayed queue. Updated under the queue's
+  // lock, since tasks posted from other threads reorder the queue.
+  size_t heap_index_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_DELAYED_TASK_HANDLE_H_
@@ -0,0 +1,39 @@
+#include "base/task/sequenced_task_runner.h"
+
+#include "base/check.h"
+
+namespace base {
+
+namespace {
+
+thread_local SequencedTaskRunner::CurrentDefaultHandle*
+    current_default_handle = nullptr;
+
+}  // namespace
+
+// static
+const scoped_refptr<SequencedTaskRunner>&
+SequencedTaskRunner::GetCurrentDefault() {
+  CHECK(current_default_handle);
+  return current_default_handle->task_runner_;
+}
+
+// static
+bool SequencedTaskRunner::HasCurrentDefault() {
+  return current_default_handle != nullptr;
+}
+
+SequencedTaskRunner::CurrentDefaultHandle::CurrentDefaultHandle(
+    scoped_refptr<SequencedTaskRunner> task_runner)
+    : task_runner_(std::move(task_runner)),
+      previous_handle_(current_default_handle) {
+  DCHECK(task_runner_->RunsTasksInCurrentSequence());
+  current_default_handle = this;
+}
+
+SequencedTaskRunner::CurrentDefaultHandle::~CurrentDefaultHandle() {
+  DCHECK(current_default_handle == this);
+  current_default_handle = previous_handle_;
+}
+
+}  // namespace base
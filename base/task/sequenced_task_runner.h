@@ -0,0 +1,94 @@
+#ifndef BASE_TASK_SEQUENCED_TASK_RUNNER_H_
+#define BASE_TASK_SEQUENCED_TASK_RUNNER_H_
+
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/location.h"
+#include "base/memory/ref_counted.h"
+#include "base/task/delayed_task_handle.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Runs posted tasks one at a time, in posting order (delayed tasks in order of
+// their run time). Posting is thread-safe; tasks always run on the runner's
+// sequence.
+class SequencedTaskRunner : public RefCountedThreadSafe<SequencedTaskRunner> {
+ public:
+  // Posts `task` to run no sooner than `delay` from now. Returns false if the
+  // task could not be posted because the runner has shut down, in which case
+  // the task is destroyed.
+  virtual bool PostDelayedTask(const Location& from_here,
+                               OnceClosure task,
+                               TimeDelta delay) = 0;
+
+  bool PostTask(const Location& from_here, OnceClosure task) {
+    return PostDelayedTask(from_here, std::move(task), TimeDelta());
+  }
+
+  // Like `PostDelayedTask`, but the returned handle can cancel the task until
+  // it becomes ready to run, removing it from the runner's delayed queue. Must
+  // be called on the runner's sequence. The handle is invalid if the task
+  // could not be posted, or if `delay` is not positive.
+  virtual DelayedTaskHandle PostCancelableDelayedTask(const Location& from_here,
+                                                      OnceClosure task,
+                                                      TimeDelta delay) = 0;
+
+  // Returns true if called from the sequence that runs this runner's tasks.
+  virtual bool RunsTasksInCurrentSequence() const = 0;
+
+  // Returns the task runner for the current sequence. It is an error to call
+  // this when no `CurrentDefaultHandle` is live on the current thread.
+  static const scoped_refptr<SequencedTaskRunner>& GetCurrentDefault();
+  static bool HasCurrentDefault();
+
+  // Scopes the current default task runner for the calling thread.
+  class CurrentDefaultHandle {
+   public:
+    explicit CurrentDefaultHandle(
+        scoped_refptr<SequencedTaskRunner> task_runner);
+    CurrentDefaultHandle(const CurrentDefaultHandle&) = delete;
+    CurrentDefaultHandle& operator=(const CurrentDefaultHandle&) = delete;
+    ~CurrentDefaultHandle();
+
+   private:
+    friend class SequencedTaskRunner;
+
+    scoped_refptr<SequencedTaskRunner> task_runner_;
+    CurrentDefaultHandle* previous_handle_;
+  };
+
+ protected:
+  friend class RefCountedThreadSafe<SequencedTaskRunner>;
+
+  SequencedTaskRunner() = default;
+  virtual ~SequencedTaskRunner() = default;
+};
+
+// A `std::unique_ptr` deleter that destroys the object on `task_runner_`,
+// posting the deletion if necessary.
+struct OnTaskRunnerDeleter {
+  explicit OnTaskRunnerDeleter(scoped_refptr<SequencedTaskRunner> task_runner)
+      : task_runner_(std::move(task_runner)) {}
+
+  template <typename T>
+  void operator()(const T* ptr) {
+    if (!ptr) {
+      return;
+    }
+    if (task_runner_->RunsTasksInCurrentSequence()) {
+      delete ptr;
+      return;
+    }
+    // If the runner has shut down the object is leaked rather than destroyed
+    // on the wrong sequence.
+    task_runner_->PostTask(FROM_HERE,
+                           BindOnce([](const T* ptr) { delete ptr; }, ptr));
+  }
+
+  scoped_refptr<SequencedTaskRunner> task_runner_;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_SEQUENCED_TASK_RUNNER_H_
@@ -0,0 +1,28 @@
+#include "base/task/single_thread_task_executor.h"
+
+#include "base/check.h"
+#include "base/memory/ref_counted.h"
+#include "base/task/task_queue.h"
+
+namespace base {
+
+SingleThreadTaskExecutor::SingleThreadTaskExecutor()
+    : task_queue_(MakeRefCounted<internal::TaskQueue>()),
+      task_runner_(task_queue_),
+      default_handle_(task_runner_),
+      sequence_local_storage_(
+          std::make_unique<internal::SequenceLocalStorageMap>()),
+      scoped_set_sequence_local_storage_(sequence_local_storage_.get()) {
+  CHECK(!internal::TaskQueue::GetCurrent());
+  internal::TaskQueue::SetCurrent(task_queue_.get());
+}
+
+SingleThreadTaskExecutor::~SingleThreadTaskExecutor() {
+  task_queue_->Shutdown();
+  // Sequence-local values are destroyed while the current thread's queue is
+  // still set, since their destructors may refer to it.
+  sequence_local_storage_.reset();
+  internal::TaskQueue::SetCurrent(nullptr);
+}
+
+}  // namespace base
@@ -0,0 +1,45 @@
+#ifndef BASE_TASK_SINGLE_THREAD_TASK_EXECUTOR_H_
+#define BASE_TASK_SINGLE_THREAD_TASK_EXECUTOR_H_
+
+#include <memory>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/threading/sequence_local_storage_map.h"
+
+namespace base {
+
+namespace internal {
+class TaskQueue;
+}  // namespace internal
+
+// A minimal stand-in for Chromium's task environment: creates a task queue
+// bound to the current thread and installs it as the current default
+// `SequencedTaskRunner`, along with sequence-local storage. Tasks are run by a
+// `RunLoop` on the same thread. Pending tasks are destroyed, and further posts
+// are rejected, when the executor is destroyed; sequence-local values are
+// destroyed after that.
+class SingleThreadTaskExecutor {
+ public:
+  SingleThreadTaskExecutor();
+  SingleThreadTaskExecutor(const SingleThreadTaskExecutor&) = delete;
+  SingleThreadTaskExecutor& operator=(const SingleThreadTaskExecutor&) =
+      delete;
+  ~SingleThreadTaskExecutor();
+
+  const scoped_refptr<SequencedTaskRunner>& task_runner() const {
+    return task_runner_;
+  }
+
+ private:
+  scoped_refptr<internal::TaskQueue> task_queue_;
+  scoped_refptr<SequencedTaskRunner> task_runner_;
+  SequencedTaskRunner::CurrentDefaultHandle default_handle_;
+  std::unique_ptr<internal::SequenceLocalStorageMap> sequence_local_storage_;
+  internal::ScopedSetSequenceLocalStorageMapForCurrentThread
+      scoped_set_sequence_local_storage_;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_SINGLE_THREAD_TASK_EXECUTOR_H_
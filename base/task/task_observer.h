@@ -0,0 +1,20 @@
+#ifndef BASE_TASK_TASK_OBSERVER_H_
+#define BASE_TASK_TASK_OBSERVER_H_
+
+namespace base {
+
+// Observes the tasks run by the current thread's task queue. Register with
+// `CurrentThread::AddTaskObserver()`.
+class TaskObserver {
+ public:
+  // Called before and after each task, on the thread that runs it.
+  virtual void WillProcessTask() = 0;
+  virtual void DidProcessTask() = 0;
+
+ protected:
+  virtual ~TaskObserver() = default;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_TASK_OBSERVER_H_
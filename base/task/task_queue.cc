@@ -0,0 +1,272 @@
+#include "base/task/task_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "base/check.h"
+#include "base/task/task_observer.h"
+
+namespace base::internal {
+
+namespace {
+
+thread_local TaskQueue* current_task_queue = nullptr;
+
+}  // namespace
+
+TaskQueue::TaskQueue() : thread_id_(std::this_thread::get_id()) {}
+
+TaskQueue::~TaskQueue() = default;
+
+// static
+TaskQueue* TaskQueue::GetCurrent() {
+  return current_task_queue;
+}
+
+// static
+void TaskQueue::SetCurrent(TaskQueue* task_queue) {
+  current_task_queue = task_queue;
+}
+
+bool TaskQueue::PostDelayedTask(const Location& from_here,
+                                OnceClosure task,
+                                TimeDelta delay) {
+  return PostDelayedTaskImpl(from_here, std::move(task), delay,
+                             /*handle=*/nullptr);
+}
+
+DelayedTaskHandle TaskQueue::PostCancelableDelayedTask(
+    const Location& from_here,
+    OnceClosure task,
+    TimeDelta delay) {
+  // Handles are only modified by other threads under the lock, to keep track
+  // of their task's position, so they must belong to the owning thread.
+  DCHECK(RunsTasksInCurrentSequence());
+  DelayedTaskHandle handle;
+  PostDelayedTaskImpl(from_here, std::move(task), delay, &handle);
+  return handle;
+}
+
+bool TaskQueue::PostDelayedTaskImpl(const Location& from_here,
+                                    OnceClosure task,
+                                    TimeDelta delay,
+                                    DelayedTaskHandle* handle) {
+  DCHECK(task);
+  std::unique_lock<std::mutex> lock(lock_);
+  if (shutdown_) {
+    // Destroy the task outside of the lock, since its destructor may post.
+    lock.unlock();
+    return false;
+  }
+  PendingTask pending_task{std::move(task), from_here, TimeTicks(),
+                           next_sequence_num_++, /*handle=*/nullptr};
+  if (delay.is_positive()) {
+    pending_task.delayed_run_time = TimeTicks::Now() + delay;
+    if (handle) {
+      pending_task.handle = handle;
+      handle->task_queue_ = this;
+    }
+    PushDelayedTaskLocked(std::move(pending_task));
+  } else {
+    incoming_queue_.push_back(std::move(pending_task));
+  }
+  if (waiting_for_work_) {
+    work_available_.notify_one();
+  }
+  return true;
+}
+
+bool TaskQueue::RunsTasksInCurrentSequence() const {
+  return std::this_thread::get_id() == thread_id_;
+}
+
+bool TaskQueue::RunNextTask() {
+  DCHECK(RunsTasksInCurrentSequence());
+  if (work_queue_index_ == work_queue_.size()) {
+    work_queue_.clear();
+    work_queue_index_ = 0;
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!delayed_queue_.empty()) {
+      MoveReadyDelayedTasksLocked(TimeTicks::Now());
+    }
+    work_queue_.swap(incoming_queue_);
+    if (work_queue_.empty()) {
+      return false;
+    }
+  }
+  // Move the task out before running it, since a nested `RunLoop` may
+  // consume the rest of the work queue.
+  OnceClosure task = std::move(work_queue_[work_queue_index_++].task);
+  // Observers may add or remove observers, so iterate by index.
+  ++task_depth_;
+  for (size_t i = 0; i < task_observers_.size(); ++i) {
+    task_observers_[i]->WillProcessTask();
+  }
+  std::move(task).Run();
+  for (size_t i = 0; i < task_observers_.size(); ++i) {
+    task_observers_[i]->DidProcessTask();
+  }
+  --task_depth_;
+  return true;
+}
+
+void TaskQueue::WaitForWork() {
+  DCHECK(RunsTasksInCurrentSequence());
+  if (work_queue_index_ < work_queue_.size()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(lock_);
+  if (!incoming_queue_.empty()) {
+    return;
+  }
+  waiting_for_work_ = true;
+  if (delayed_queue_.empty()) {
+    work_available_.wait(lock);
+  } else {
+    TimeDelta delay = delayed_queue_.front().delayed_run_time - TimeTicks::Now();
+    if (delay.is_positive()) {
+      work_available_.wait_for(
+          lock, std::chrono::microseconds(delay.InMicroseconds()));
+    }
+  }
+  waiting_for_work_ = false;
+}
+
+void TaskQueue::Shutdown() {
+  DCHECK(RunsTasksInCurrentSequence());
+  std::vector<PendingTask> work_queue;
+  std::vector<PendingTask> incoming_queue;
+  std::vector<PendingTask> delayed_queue;
+  work_queue.swap(work_queue_);
+  work_queue_index_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    shutdown_ = true;
+    incoming_queue.swap(incoming_queue_);
+    delayed_queue.swap(delayed_queue_);
+    for (PendingTask& pending_task : delayed_queue) {
+      if (pending_task.handle) {
+        pending_task.handle->task_queue_ = nullptr;
+      }
+    }
+  }
+  // Tasks are destroyed here, outside of the lock.
+}
+
+uint64_t TaskQueue::GetNumPostedTasks() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return next_sequence_num_;
+}
+
+size_t TaskQueue::GetNumDelayedTasks() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return delayed_queue_.size();
+}
+
+void TaskQueue::AddTaskObserver(TaskObserver* observer) {
+  DCHECK(RunsTasksInCurrentSequence());
+  task_observers_.push_back(observer);
+}
+
+void TaskQueue::RemoveTaskObserver(TaskObserver* observer) {
+  DCHECK(RunsTasksInCurrentSequence());
+  std::erase(task_observers_, observer);
+}
+
+void TaskQueue::MoveReadyDelayedTasksLocked(TimeTicks now) {
+  while (!delayed_queue_.empty() &&
+         delayed_queue_.front().delayed_run_time <= now) {
+    incoming_queue_.push_back(TakeDelayedTaskLocked(0));
+  }
+}
+
+void TaskQueue::CancelDelayedTask(DelayedTaskHandle& handle) {
+  DCHECK(RunsTasksInCurrentSequence());
+  PendingTask pending_task;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    DCHECK(handle.task_queue_ == this);
+    pending_task = TakeDelayedTaskLocked(handle.heap_index_);
+  }
+  // The task is destroyed here, outside of the lock, and may own `handle`.
+}
+
+void TaskQueue::MoveDelayedTaskHandle(DelayedTaskHandle& from,
+                                      DelayedTaskHandle& to) {
+  DCHECK(RunsTasksInCurrentSequence());
+  std::lock_guard<std::mutex> lock(lock_);
+  DCHECK(from.task_queue_ == this);
+  to.task_queue_ = std::exchange(from.task_queue_, nullptr);
+  to.heap_index_ = from.heap_index_;
+  delayed_queue_[to.heap_index_].handle = &to;
+}
+
+void TaskQueue::PushDelayedTaskLocked(PendingTask pending_task) {
+  delayed_queue_.push_back(std::move(pending_task));
+  size_t index = delayed_queue_.size() - 1;
+  if (delayed_queue_[index].handle) {
+    delayed_queue_[index].handle->heap_index_ = index;
+  }
+  SiftUpLocked(index);
+}
+
+TaskQueue::PendingTask TaskQueue::TakeDelayedTaskLocked(size_t index) {
+  DCHECK(index < delayed_queue_.size());
+  size_t last = delayed_queue_.size() - 1;
+  if (index != last) {
+    SwapDelayedTasksLocked(index, last);
+  }
+  PendingTask pending_task = std::move(delayed_queue_.back());
+  delayed_queue_.pop_back();
+  if (index != last) {
+    // The task moved into the hole may belong either above or below it.
+    SiftUpLocked(index);
+    SiftDownLocked(index);
+  }
+  if (DelayedTaskHandle* handle = std::exchange(pending_task.handle, nullptr)) {
+    handle->task_queue_ = nullptr;
+  }
+  return pending_task;
+}
+
+void TaskQueue::SiftUpLocked(size_t index) {
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!DelayedTaskCompare()(delayed_queue_[parent], delayed_queue_[index])) {
+      return;
+    }
+    SwapDelayedTasksLocked(parent, index);
+    index = parent;
+  }
+}
+
+void TaskQueue::SiftDownLocked(size_t index) {
+  size_t size = delayed_queue_.size();
+  while (true) {
+    size_t earliest = index;
+    for (size_t child : {2 * index + 1, 2 * index + 2}) {
+      if (child < size && DelayedTaskCompare()(delayed_queue_[earliest],
+                                               delayed_queue_[child])) {
+        earliest = child;
+      }
+    }
+    if (earliest == index) {
+      return;
+    }
+    SwapDelayedTasksLocked(index, earliest);
+    index = earliest;
+  }
+}
+
+void TaskQueue::SwapDelayedTasksLocked(size_t a, size_t b) {
+  std::swap(delayed_queue_[a], delayed_queue_[b]);
+  if (delayed_queue_[a].handle) {
+    delayed_queue_[a].handle->heap_index_ = a;
+  }
+  if (delayed_queue_[b].handle) {
+    delayed_queue_[b].handle->heap_index_ = b;
+  }
+}
+
+}  // namespace base::internal
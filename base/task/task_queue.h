@@ -0,0 +1,136 @@
+#ifndef BASE_TASK_TASK_QUEUE_H_
+#define BASE_TASK_TASK_QUEUE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/functional/callback.h"
+#include "base/location.h"
+#include "base/task/delayed_task_handle.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class TaskObserver;
+
+namespace internal {
+
+// The queue behind `SingleThreadTaskExecutor`. Tasks may be posted from any
+// thread, and are run on the thread that created the queue by `RunLoop`.
+class TaskQueue : public SequencedTaskRunner {
+ public:
+  TaskQueue();
+
+  // Returns the queue bound to the current thread, or null.
+  static TaskQueue* GetCurrent();
+  static void SetCurrent(TaskQueue* task_queue);
+
+  // SequencedTaskRunner:
+  bool PostDelayedTask(const Location& from_here,
+                       OnceClosure task,
+                       TimeDelta delay) override;
+  DelayedTaskHandle PostCancelableDelayedTask(const Location& from_here,
+                                              OnceClosure task,
+                                              TimeDelta delay) override;
+  bool RunsTasksInCurrentSequence() const override;
+
+  // Runs the next task that is ready to run. Returns false if no task was
+  // ready.
+  bool RunNextTask();
+
+  // Blocks until a task may be ready to run. May return spuriously.
+  void WaitForWork();
+
+  // Destroys all pending tasks and rejects any further posts.
+  void Shutdown();
+
+  // Returns the number of tasks successfully posted so far.
+  uint64_t GetNumPostedTasks() const;
+
+  // Returns the number of delayed tasks waiting for their run time.
+  size_t GetNumDelayedTasks() const;
+
+  // Observers are notified around each task run by `RunNextTask()`. See
+  // `CurrentThread`.
+  void AddTaskObserver(TaskObserver* observer);
+  void RemoveTaskObserver(TaskObserver* observer);
+
+  bool IsRunningTask() const { return task_depth_ > 0; }
+
+ private:
+  friend class base::DelayedTaskHandle;
+
+  struct PendingTask {
+    OnceClosure task;
+    Location posted_from;
+    TimeTicks delayed_run_time;
+    uint64_t sequence_num = 0;
+    // The handle of a cancelable task, while it is in the delayed queue.
+    DelayedTaskHandle* handle = nullptr;
+  };
+
+  // Orders the delayed heap so that the earliest run time is at the front.
+  struct DelayedTaskCompare {
+    bool operator()(const PendingTask& a, const PendingTask& b) const {
+      if (a.delayed_run_time != b.delayed_run_time) {
+        return a.delayed_run_time > b.delayed_run_time;
+      }
+      return a.sequence_num > b.sequence_num;
+    }
+  };
+
+  ~TaskQueue() override;
+
+  // Posts `task`, setting `handle` to refer to it if it is delayed.
+  bool PostDelayedTaskImpl(const Location& from_here,
+                           OnceClosure task,
+                           TimeDelta delay,
+                           DelayedTaskHandle* handle);
+
+  // Moves delayed tasks whose run time has been reached to the incoming
+  // queue.
+  void MoveReadyDelayedTasksLocked(TimeTicks now);
+
+  // Called through `DelayedTaskHandle`, on the owning thread.
+  void CancelDelayedTask(DelayedTaskHandle& handle);
+  void MoveDelayedTaskHandle(DelayedTaskHandle& from, DelayedTaskHandle& to);
+
+  // Maintain `delayed_queue_` as a binary heap whose entries know their
+  // position, so that a cancelled task can be removed from the middle of it
+  // in logarithmic time.
+  void PushDelayedTaskLocked(PendingTask pending_task);
+  PendingTask TakeDelayedTaskLocked(size_t index);
+  void SiftUpLocked(size_t index);
+  void SiftDownLocked(size_t index);
+  void SwapDelayedTasksLocked(size_t a, size_t b);
+
+  const std::thread::id thread_id_;
+
+  // Tasks ready to run, consumed from `work_queue_index_` by the owning
+  // thread without taking the lock. When exhausted, it is swapped with
+  // `incoming_queue_`. Both vectors keep their capacity, so steady-state
+  // posting does not allocate.
+  std::vector<PendingTask> work_queue_;
+  size_t work_queue_index_ = 0;
+
+  // Accessed only by the owning thread.
+  std::vector<TaskObserver*> task_observers_;
+  int task_depth_ = 0;
+
+  mutable std::mutex lock_;
+  std::condition_variable work_available_;
+  std::vector<PendingTask> incoming_queue_;
+  std::vector<PendingTask> delayed_queue_;
+  uint64_t next_sequence_num_ = 0;
+  bool waiting_for_work_ = false;
+  bool shutdown_ = false;
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_TASK_QUEUE_H_
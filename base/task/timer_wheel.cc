@@ -0,0 +1,235 @@
+#include "base/task/timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/location.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/threading/sequence_local_storage_slot.h"
+
+namespace base {
+
+namespace {
+
+// Bounds delays so that tick arithmetic cannot overflow. About 36,000 years.
+constexpr int64_t kMaxDelayMicroseconds = int64_t{1} << 60;
+
+SequenceLocalStorageSlot<TimerWheel>& GetTimerWheelSlot() {
+  static SequenceLocalStorageSlot<TimerWheel> slot;
+  return slot;
+}
+
+}  // namespace
+
+void TimerWheel::Timer::Cancel() {
+  if (wheel_) {
+    wheel_->Remove(*this);
+  }
+}
+
+// static
+TimerWheel& TimerWheel::GetForCurrentSequence() {
+  return GetTimerWheelSlot().GetOrCreateValue();
+}
+
+TimerWheel::TimerWheel() : origin_(TimeTicks::Now()) {}
+
+TimerWheel::~TimerWheel() {
+  // Timers may cancel one another, or destroy whatever owns them, when told
+  // that the wheel is going away, so take them one at a time.
+  for (auto& level : slots_) {
+    for (Slot& slot : level) {
+      while (!slot.empty()) {
+        Timer& timer = *slot.next_;
+        Remove(timer);
+        timer.OnTimerWheelDestroyed();
+      }
+    }
+  }
+}
+
+void TimerWheel::SetSlack(TimeDelta slack) {
+  CHECK(slack.is_positive());
+  CHECK(num_timers_ == 0);
+  slack_ = slack;
+  origin_ = TimeTicks::Now();
+  now_ = 0;
+  // A wake-up left scheduled by the last timer is in ticks of the old slack,
+  // and would otherwise be mistaken for one that new timers can share.
+  wake_up_.CancelTask();
+  wake_up_tick_ = kNoWakeUp;
+}
+
+void TimerWheel::Schedule(Timer& timer, TimeDelta delay) {
+  timer.Cancel();
+  const TimeTicks now = TimeTicks::Now();
+  if (num_timers_ == 0) {
+    // Nothing is placed relative to `now_`, so catch up, which keeps new
+    // timers in the lowest levels.
+    now_ = GetTickAt(now);
+  }
+  const int64_t delay_us = std::min(
+      std::max(delay.InMicroseconds(), int64_t{0}), kMaxDelayMicroseconds);
+  const int64_t elapsed_us = (now - origin_).InMicroseconds() + delay_us;
+  const int64_t slack_us = slack_.InMicroseconds();
+  // Round up, so that the timer never fires early.
+  timer.expiry_tick_ =
+      std::max(elapsed_us / slack_us + (elapsed_us % slack_us != 0), now_ + 1);
+  timer.wheel_ = this;
+  ++num_timers_;
+  const int64_t event_tick = Insert(timer);
+  if (event_tick < wake_up_tick_) {
+    ScheduleWakeUp(event_tick);
+  }
+}
+
+// static
+void TimerWheel::Link(Timer& head, Timer& timer) {
+  timer.prev_ = head.prev_;
+  timer.next_ = &head;
+  head.prev_->next_ = &timer;
+  head.prev_ = &timer;
+}
+
+// static
+void TimerWheel::Unlink(Timer& timer) {
+  timer.prev_->next_ = timer.next_;
+  timer.next_->prev_ = timer.prev_;
+  timer.prev_ = timer.next_ = nullptr;
+}
+
+// static
+void TimerWheel::Splice(Slot& from, Slot& to) {
+  DCHECK(to.empty());
+  if (from.empty()) {
+    return;
+  }
+  to.next_ = from.next_;
+  to.prev_ = from.prev_;
+  to.next_->prev_ = &to;
+  to.prev_->next_ = &to;
+  from.next_ = from.prev_ = &from;
+}
+
+int64_t TimerWheel::GetTickAt(TimeTicks time) const {
+  return (time - origin_) / slack_;
+}
+
+TimeTicks TimerWheel::GetTimeOfTick(int64_t tick) const {
+  return origin_ + slack_ * tick;
+}
+
+int64_t TimerWheel::Insert(Timer& timer) {
+  int64_t placement_tick = timer.expiry_tick_;
+  const int64_t delta = placement_tick - now_;
+  int level = 0;
+  if (delta >= kNumSlots) {
+    level = (std::bit_width(static_cast<uint64_t>(delta)) - 1) / kSlotBits;
+    if (level >= kNumLevels) {
+      level = kNumLevels - 1;
+      placement_tick = now_ + (int64_t{1} << (kSlotBits * kNumLevels)) - 1;
+    }
+  }
+  const int shift = kSlotBits * level;
+  const int index = (placement_tick >> shift) & (kNumSlots - 1);
+  Link(slots_[level][index], timer);
+  occupied_[level] |= uint64_t{1} << index;
+  // The slot is reached when the wheel enters the span it covers. Timers due
+  // at `now_` go to the current first-level slot, which is processed last.
+  return std::max((placement_tick >> shift) << shift, now_);
+}
+
+void TimerWheel::Remove(Timer& timer) {
+  DCHECK(timer.wheel_ == this);
+  Unlink(timer);
+  timer.wheel_ = nullptr;
+  // The wake-up is left scheduled when the wheel empties, so that starting
+  // and cancelling a lone timer does not post and cancel a task each time.
+  --num_timers_;
+}
+
+int64_t TimerWheel::GetNextEventTick() {
+  int64_t next_tick = kNoWakeUp;
+  for (int level = 0; level < kNumLevels; ++level) {
+    const int shift = kSlotBits * level;
+    const int64_t position = now_ >> shift;
+    const int first = (position + 1) & (kNumSlots - 1);
+    while (occupied_[level]) {
+      // Bit `i` of `rotated` is the slot `i + 1` positions ahead, whose span
+      // starts `i + 1` spans from now. The current slot comes last, a full
+      // rotation ahead.
+      const uint64_t rotated = std::rotr(occupied_[level], first);
+      const int ahead = std::countr_zero(rotated) + 1;
+      const int index = (first + ahead - 1) & (kNumSlots - 1);
+      if (slots_[level][index].empty()) {
+        occupied_[level] &= ~(uint64_t{1} << index);
+        continue;
+      }
+      next_tick = std::min(next_tick, (position + ahead) << shift);
+      break;
+    }
+  }
+  return next_tick;
+}
+
+void TimerWheel::AdvanceTo(int64_t tick) {
+  while (true) {
+    const int64_t next_tick = GetNextEventTick();
+    if (next_tick > tick) {
+      // A timer that fired may have emptied the wheel and scheduled another,
+      // moving `now_` up to the current time.
+      now_ = std::max(now_, tick);
+      return;
+    }
+    now_ = next_tick;
+    // Move timers down from the higher levels whose slot starts now, highest
+    // first, so that timers due now all reach the first level.
+    for (int level = kNumLevels - 1; level > 0; --level) {
+      const int shift = kSlotBits * level;
+      if (now_ & ((int64_t{1} << shift) - 1)) {
+        continue;
+      }
+      Slot pending;
+      Splice(slots_[level][(now_ >> shift) & (kNumSlots - 1)], pending);
+      while (!pending.empty()) {
+        Timer& timer = *pending.next_;
+        Unlink(timer);
+        Insert(timer);
+      }
+    }
+    // Timers may cancel or schedule others when they fire. The slot is
+    // emptied first, so that new timers, which are due later, do not run in
+    // this pass.
+    Slot pending;
+    Splice(slots_[0][now_ & (kNumSlots - 1)], pending);
+    while (!pending.empty()) {
+      Timer& timer = *pending.next_;
+      Remove(timer);
+      timer.OnTimerFired();
+    }
+  }
+}
+
+void TimerWheel::ScheduleWakeUp(int64_t tick) {
+  wake_up_tick_ = tick;
+  // Replacing the handle cancels the previous wake-up. A wake-up that is
+  // already due runs anyway, and finds nothing to do.
+  wake_up_ =
+      SequencedTaskRunner::GetCurrentDefault()->PostCancelableDelayedTask(
+          FROM_HERE, BindOnce(&TimerWheel::OnWakeUp, this),
+          GetTimeOfTick(tick) - TimeTicks::Now());
+}
+
+void TimerWheel::OnWakeUp() {
+  wake_up_tick_ = kNoWakeUp;
+  AdvanceTo(std::max(GetTickAt(TimeTicks::Now()), now_));
+  const int64_t next_tick = GetNextEventTick();
+  if (next_tick != kNoWakeUp && next_tick < wake_up_tick_) {
+    ScheduleWakeUp(next_tick);
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,148 @@
+#ifndef BASE_TASK_TIMER_WHEEL_H_
+#define BASE_TASK_TIMER_WHEEL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "base/task/delayed_task_handle.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Runs large numbers of timers on the current sequence with a single delayed
+// task. Timers are linked into the slots of a hierarchical wheel: each level
+// has 64 slots, and each slot of a level spans a whole rotation of the level
+// below. A timer is inserted into the level that its delay falls in and moves
+// down a level each time the wheel reaches its slot, so inserting and
+// cancelling a timer take constant time however many are pending, unlike a
+// delayed task, whose heap entry costs logarithmic time.
+//
+// Run times are rounded up to a multiple of the wheel's slack, so a timer
+// fires up to `slack()` late, and timers that come due in the same slack
+// interval fire together from one wake-up.
+//
+// The wheel and its timers must be used on a single sequence.
+class TimerWheel {
+ public:
+  // A timer on the wheel. Subclasses implement `OnTimerFired()`; the timer is
+  // no longer scheduled when it runs, and may be destroyed or rescheduled
+  // from it. Timers do not allocate, and cancel themselves when destroyed.
+  class Timer {
+   public:
+    Timer() = default;
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+    virtual ~Timer() { Cancel(); }
+
+    bool IsScheduled() const { return wheel_ != nullptr; }
+
+    // Removes the timer from its wheel, if it is scheduled.
+    void Cancel();
+
+   protected:
+    // Runs from the wheel's own wake-up task, so there is no need to post a
+    // continuation from it: futures may be resolved with
+    // `Promise::SetValueWithSideEffects()`.
+    virtual void OnTimerFired() = 0;
+
+    // Called instead when the wheel is destroyed, with the sequence's
+    // sequence-local storage, while the timer is scheduled. The timer has
+    // been removed from the wheel and may be destroyed.
+    virtual void OnTimerWheelDestroyed() {}
+
+   private:
+    friend class TimerWheel;
+
+    // The slot's list is circular, with the slot itself as its head.
+    Timer* prev_ = nullptr;
+    Timer* next_ = nullptr;
+    // The tick at which the timer fires.
+    int64_t expiry_tick_ = 0;
+    TimerWheel* wheel_ = nullptr;
+  };
+
+  static constexpr TimeDelta kDefaultSlack = Milliseconds(1);
+
+  // Returns the current sequence's wheel, creating it with the default slack
+  // if necessary.
+  static TimerWheel& GetForCurrentSequence();
+
+  TimerWheel();
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  ~TimerWheel();
+
+  TimeDelta slack() const { return slack_; }
+
+  // Sets the wheel's granularity. Coarser slack means fewer wake-ups when
+  // timers are spread out, at the cost of precision. It is an error to
+  // change it while timers are scheduled.
+  void SetSlack(TimeDelta slack);
+
+  // Schedules `timer` to fire once `delay` has elapsed, cancelling it first if
+  // it was already scheduled.
+  void Schedule(Timer& timer, TimeDelta delay);
+
+  size_t GetNumTimers() const { return num_timers_; }
+
+ private:
+  // Each level has 64 slots and covers 64 times the span of the level below,
+  // so with the default slack, timers up to twelve days out are placed
+  // directly. Later timers wait in the top level's last slot and are placed
+  // again when the wheel reaches it.
+  static constexpr int kSlotBits = 6;
+  static constexpr int kNumSlots = 1 << kSlotBits;
+  static constexpr int kNumLevels = 5;
+  static constexpr int64_t kNoWakeUp = std::numeric_limits<int64_t>::max();
+
+  // The head of a slot's list, which only uses the link fields.
+  struct Slot final : Timer {
+    Slot() { prev_ = next_ = this; }
+    bool empty() const { return next_ == this; }
+    void OnTimerFired() override {}
+  };
+
+  static void Link(Timer& head, Timer& timer);
+  static void Unlink(Timer& timer);
+  // Moves the list of `from` to `to`, which must be empty.
+  static void Splice(Slot& from, Slot& to);
+
+  int64_t GetTickAt(TimeTicks time) const;
+  TimeTicks GetTimeOfTick(int64_t tick) const;
+
+  // Links `timer` into the slot for its expiry tick relative to `now_`, and
+  // returns the tick at which the wheel must reach that slot.
+  int64_t Insert(Timer& timer);
+  void Remove(Timer& timer);
+
+  // Returns the first tick after `now_` at which a slot needs processing, or
+  // `kNoWakeUp`.
+  int64_t GetNextEventTick();
+
+  // Moves `now_` to `tick`, processing every slot on the way: timers in
+  // higher levels move down, and those in the first level fire.
+  void AdvanceTo(int64_t tick);
+
+  void ScheduleWakeUp(int64_t tick);
+  void OnWakeUp();
+
+  TimeDelta slack_ = kDefaultSlack;
+  // Tick 0 is at `origin_`, and each tick is `slack_` long.
+  TimeTicks origin_;
+  // The last tick processed.
+  int64_t now_ = 0;
+  std::array<std::array<Slot, kNumSlots>, kNumLevels> slots_;
+  // A bit per slot that may be non-empty. Cancelling leaves the bit set, and
+  // the next scan clears it.
+  std::array<uint64_t, kNumLevels> occupied_{};
+  size_t num_timers_ = 0;
+  // The delayed task that runs `OnWakeUp()`, and the tick it runs at.
+  DelayedTaskHandle wake_up_;
+  int64_t wake_up_tick_ = kNoWakeUp;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_TIMER_WHEEL_H_
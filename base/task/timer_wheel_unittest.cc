@@ -0,0 +1,79 @@
+// Checks when timers on a `TimerWheel` fire.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include "base/task/timer_wheel.h"
+
+#include "base/check.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace {
+
+// Records when it fires, and quits the loop that waits for it.
+class RecordingTimer : public TimerWheel::Timer {
+ public:
+  explicit RecordingTimer(RunLoop* run_loop = nullptr) : run_loop_(run_loop) {}
+
+  const TimeTicks& fired_at() const { return fired_at_; }
+
+ private:
+  // TimerWheel::Timer:
+  void OnTimerFired() override {
+    fired_at_ = TimeTicks::Now();
+    if (run_loop_) {
+      run_loop_->Quit();
+    }
+  }
+
+  RunLoop* const run_loop_;
+  TimeTicks fired_at_;
+};
+
+void TestTimerFiresAfterItsDelay() {
+  SingleThreadTaskExecutor executor;
+  TimerWheel& wheel = TimerWheel::GetForCurrentSequence();
+  RunLoop run_loop;
+  RecordingTimer timer(&run_loop);
+  const TimeTicks start = TimeTicks::Now();
+  wheel.Schedule(timer, Milliseconds(10));
+  run_loop.Run();
+  const TimeDelta elapsed = timer.fired_at() - start;
+  CHECK(elapsed >= Milliseconds(10));
+  CHECK(elapsed < Seconds(1));
+  CHECK(wheel.GetNumTimers() == 0);
+}
+
+// The last timer cancelled leaves its wake-up scheduled, in ticks of the slack
+// at the time. Changing the slack must not let a new timer share it.
+void TestSlackChangeDropsPendingWakeUp() {
+  SingleThreadTaskExecutor executor;
+  TimerWheel& wheel = TimerWheel::GetForCurrentSequence();
+  wheel.SetSlack(Seconds(1));
+  {
+    RecordingTimer cancelled;
+    wheel.Schedule(cancelled, Seconds(5));
+    cancelled.Cancel();
+  }
+  wheel.SetSlack(Milliseconds(1));
+  RunLoop run_loop;
+  RecordingTimer timer(&run_loop);
+  const TimeTicks start = TimeTicks::Now();
+  wheel.Schedule(timer, Milliseconds(10));
+  run_loop.Run();
+  const TimeDelta elapsed = timer.fired_at() - start;
+  CHECK(elapsed >= Milliseconds(10));
+  CHECK(elapsed < Seconds(1));
+}
+
+}  // namespace
+}  // namespace base
+
+int main() {
+  base::TestTimerFiresAfterItsDelay();
+  base::TestSlackChangeDropsPendingWakeUp();
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "base/threading/sequence_local_storage_map.h"
+
+#include <atomic>
+
+#include "base/check.h"
+
+namespace base::internal {
+
+namespace {
+
+thread_local SequenceLocalStorageMap* current_sequence_local_storage = nullptr;
+
+std::atomic<int> g_next_slot_number{0};
+
+}  // namespace
+
+SequenceLocalStorageMap::SequenceLocalStorageMap() = default;
+
+SequenceLocalStorageMap::~SequenceLocalStorageMap() {
+  // Values may look up other slots while being destroyed, so each entry is
+  // cleared before its destructor runs. They may also create values, which are
+  // destroyed in turn.
+  while (!creation_order_.empty() || !destroyed_last_order_.empty()) {
+    std::vector<int>& order =
+        creation_order_.empty() ? destroyed_last_order_ : creation_order_;
+    int slot_id = order.back();
+    order.pop_back();
+    Entry entry = values_[slot_id];
+    values_[slot_id] = Entry();
+    entry.destructor(entry.value);
+  }
+}
+
+// static
+SequenceLocalStorageMap& SequenceLocalStorageMap::GetForCurrentThread() {
+  CHECK(current_sequence_local_storage);
+  return *current_sequence_local_storage;
+}
+
+// static
+bool SequenceLocalStorageMap::IsSetForCurrentThread() {
+  return current_sequence_local_storage != nullptr;
+}
+
+void SequenceLocalStorageMap::Set(int slot_id,
+                                  void* value,
+                                  Destructor destructor) {
+  if (static_cast<size_t>(slot_id) >= values_.size()) {
+    values_.resize(slot_id + 1);
+  }
+  CHECK(!values_[slot_id].value);
+  values_[slot_id] = Entry{value, destructor};
+  creation_order_.push_back(slot_id);
+}
+
+void SequenceLocalStorageMap::SetDestroyedLast(int slot_id,
+                                               void* value,
+                                               Destructor destructor) {
+  Set(slot_id, value, destructor);
+  creation_order_.pop_back();
+  destroyed_last_order_.push_back(slot_id);
+}
+
+ScopedSetSequenceLocalStorageMapForCurrentThread::
+    ScopedSetSequenceLocalStorageMapForCurrentThread(
+        SequenceLocalStorageMap* map)
+    : previous_map_(current_sequence_local_storage) {
+  current_sequence_local_storage = map;
+}
+
+ScopedSetSequenceLocalStorageMapForCurrentThread::
+    ~ScopedSetSequenceLocalStorageMapForCurrentThread() {
+  current_sequence_local_storage = previous_map_;
+}
+
+int GetNextSequenceLocalStorageSlotNumber() {
+  return g_next_slot_number.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace base::internal
@@ -0,0 +1,74 @@
+#ifndef BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
+#define BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace base::internal {
+
+// Holds the values of all `SequenceLocalStorageSlot`s for one sequence. Values
+// are destroyed, in reverse order of creation, with the map; values stored with
+// `SetDestroyedLast()` are destroyed after all others.
+class SequenceLocalStorageMap {
+ public:
+  using Destructor = void (*)(void*);
+
+  SequenceLocalStorageMap();
+  SequenceLocalStorageMap(const SequenceLocalStorageMap&) = delete;
+  SequenceLocalStorageMap& operator=(const SequenceLocalStorageMap&) = delete;
+  ~SequenceLocalStorageMap();
+
+  // Returns the map for the sequence running on the current thread. It is an
+  // error to call this when `IsSetForCurrentThread()` is false.
+  static SequenceLocalStorageMap& GetForCurrentThread();
+  static bool IsSetForCurrentThread();
+
+  // Returns the value stored in `slot_id`, or null.
+  void* Get(int slot_id) const {
+    return static_cast<size_t>(slot_id) < values_.size()
+               ? values_[slot_id].value
+               : nullptr;
+  }
+
+  // Stores `value` in `slot_id`, which must be empty. `destructor` is called
+  // with `value` when the map is destroyed.
+  void Set(int slot_id, void* value, Destructor destructor);
+
+  // As `Set()`, but `value` is destroyed after the values stored with `Set()`,
+  // which may use it while being destroyed.
+  void SetDestroyedLast(int slot_id, void* value, Destructor destructor);
+
+ private:
+  struct Entry {
+    void* value = nullptr;
+    Destructor destructor = nullptr;
+  };
+
+  // Indexed by slot id. Slot ids are small, dense integers.
+  std::vector<Entry> values_;
+  std::vector<int> creation_order_;
+  std::vector<int> destroyed_last_order_;
+};
+
+// Makes `map` the current thread's sequence-local storage for the lifetime of
+// this object.
+class ScopedSetSequenceLocalStorageMapForCurrentThread {
+ public:
+  explicit ScopedSetSequenceLocalStorageMapForCurrentThread(
+      SequenceLocalStorageMap* map);
+  ScopedSetSequenceLocalStorageMapForCurrentThread(
+      const ScopedSetSequenceLocalStorageMapForCurrentThread&) = delete;
+  ScopedSetSequenceLocalStorageMapForCurrentThread& operator=(
+      const ScopedSetSequenceLocalStorageMapForCurrentThread&) = delete;
+  ~ScopedSetSequenceLocalStorageMapForCurrentThread();
+
+ private:
+  SequenceLocalStorageMap* const previous_map_;
+};
+
+// Returns a process-unique slot id.
+int GetNextSequenceLocalStorageSlotNumber();
+
+}  // namespace base::internal
+
+#endif  // BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
@@ -0,0 +1,73 @@
+#ifndef BASE_THREADING_SEQUENCE_LOCAL_STORAGE_SLOT_H_
+#define BASE_THREADING_SEQUENCE_LOCAL_STORAGE_SLOT_H_
+
+#include <utility>
+
+#include "base/threading/sequence_local_storage_map.h"
+
+namespace base {
+
+// A slot for a value of type `T` that is local to the current sequence, and
+// destroyed when the sequence shuts down. Slots are typically static:
+//
+//   static SequenceLocalStorageSlot<Foo> slot;
+//   Foo& foo = slot.GetOrCreateValue();
+//
+// Accessing a slot requires sequence-local storage to be set for the current
+// thread, which `SingleThreadTaskExecutor` does.
+template <typename T>
+class SequenceLocalStorageSlot {
+ public:
+  // Values are destroyed in reverse order of creation, except that values of
+  // `kLast` slots are destroyed after all others, so that those may still use
+  // them while being destroyed.
+  enum class Destruction { kReverseCreationOrder, kLast };
+
+  explicit SequenceLocalStorageSlot(
+      Destruction destruction = Destruction::kReverseCreationOrder)
+      : slot_id_(internal::GetNextSequenceLocalStorageSlotNumber()),
+        destruction_(destruction) {}
+  SequenceLocalStorageSlot(const SequenceLocalStorageSlot&) = delete;
+  SequenceLocalStorageSlot& operator=(const SequenceLocalStorageSlot&) = delete;
+
+  // Returns the value for the current sequence, or null if there is none.
+  T* GetValuePointer() const {
+    return static_cast<T*>(
+        internal::SequenceLocalStorageMap::GetForCurrentThread().Get(
+            slot_id_));
+  }
+
+  explicit operator bool() const { return GetValuePointer() != nullptr; }
+
+  // Returns the value for the current sequence, default-constructing it if
+  // necessary.
+  T& GetOrCreateValue() {
+    T* value = GetValuePointer();
+    return value ? *value : emplace();
+  }
+
+  // Constructs the value for the current sequence, which must not exist yet.
+  template <typename... Args>
+  T& emplace(Args&&... args) {
+    T* value = new T(std::forward<Args>(args)...);
+    internal::SequenceLocalStorageMap& map =
+        internal::SequenceLocalStorageMap::GetForCurrentThread();
+    internal::SequenceLocalStorageMap::Destructor destructor = [](void* ptr) {
+      delete static_cast<T*>(ptr);
+    };
+    if (destruction_ == Destruction::kLast) {
+      map.SetDestroyedLast(slot_id_, value, destructor);
+    } else {
+      map.Set(slot_id_, value, destructor);
+    }
+    return *value;
+  }
+
+ private:
+  const int slot_id_;
+  const Destruction destruction_;
+};
+
+}  // namespace base
+
+#endif  // BASE_THREADING_SEQUENCE_LOCAL_STORAGE_SLOT_H_
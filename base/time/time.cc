@@ -0,0 +1,15 @@
+#include "base/time/time.h"
+
+#include <chrono>
+
+namespace base {
+
+// static
+TimeTicks TimeTicks::Now() {
+  auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+  return TimeTicks(
+      std::chrono::duration_cast<std::chrono::microseconds>(since_epoch)
+          .count());
+}
+
+}  // namespace base
@@ -0,0 +1,107 @@
+#ifndef BASE_TIME_TIME_H_
+#define BASE_TIME_TIME_H_
+
+#include <compare>
+#include <cstdint>
+#include <limits>
+
+namespace base {
+
+// A span of time with microsecond resolution.
+class TimeDelta {
+ public:
+  constexpr TimeDelta() = default;
+
+  static constexpr TimeDelta FromInternalValue(int64_t us) {
+    return TimeDelta(us);
+  }
+  static constexpr TimeDelta Max() {
+    return TimeDelta(std::numeric_limits<int64_t>::max());
+  }
+
+  constexpr int64_t InMicroseconds() const { return us_; }
+  constexpr int64_t InMilliseconds() const { return us_ / 1000; }
+  constexpr double InMillisecondsF() const { return us_ / 1000.0; }
+  constexpr double InSecondsF() const { return us_ / 1000000.0; }
+
+  constexpr bool is_zero() const { return us_ == 0; }
+  constexpr bool is_positive() const { return us_ > 0; }
+  constexpr bool is_max() const { return *this == Max(); }
+
+  constexpr TimeDelta operator+(TimeDelta other) const {
+    return TimeDelta(us_ + other.us_);
+  }
+  constexpr TimeDelta operator-(TimeDelta other) const {
+    return TimeDelta(us_ - other.us_);
+  }
+  constexpr TimeDelta operator*(int64_t n) const { return TimeDelta(us_ * n); }
+  constexpr TimeDelta operator/(int64_t n) const { return TimeDelta(us_ / n); }
+  constexpr int64_t operator/(TimeDelta other) const { return us_ / other.us_; }
+  constexpr TimeDelta& operator+=(TimeDelta other) {
+    us_ += other.us_;
+    return *this;
+  }
+
+  constexpr auto operator<=>(const TimeDelta&) const = default;
+
+ private:
+  constexpr explicit TimeDelta(int64_t us) : us_(us) {}
+
+  int64_t us_ = 0;
+};
+
+constexpr TimeDelta Microseconds(int64_t n) {
+  return TimeDelta::FromInternalValue(n);
+}
+constexpr TimeDelta Milliseconds(int64_t n) {
+  return Microseconds(n * 1000);
+}
+constexpr TimeDelta Seconds(int64_t n) {
+  return Microseconds(n * 1000000);
+}
+
+// A point on the monotonic clock.
+class TimeTicks {
+ public:
+  constexpr TimeTicks() = default;
+
+  static TimeTicks Now();
+
+  static constexpr TimeTicks FromInternalValue(int64_t us) {
+    return TimeTicks(us);
+  }
+  static constexpr TimeTicks Max() {
+    return TimeTicks(std::numeric_limits<int64_t>::max());
+  }
+
+  constexpr bool is_null() const { return us_ == 0; }
+  constexpr bool is_max() const { return *this == Max(); }
+  constexpr int64_t ToInternalValue() const { return us_; }
+
+  constexpr TimeTicks operator+(TimeDelta delta) const {
+    if (is_max() || delta.is_max()) {
+      return Max();
+    }
+    return TimeTicks(us_ + delta.InMicroseconds());
+  }
+  constexpr TimeTicks operator-(TimeDelta delta) const {
+    return TimeTicks(us_ - delta.InMicroseconds());
+  }
+  constexpr TimeDelta operator-(TimeTicks other) const {
+    return Microseconds(us_ - other.us_);
+  }
+  constexpr TimeTicks& operator+=(TimeDelta delta) {
+    return *this = *this + delta;
+  }
+
+  constexpr auto operator<=>(const TimeTicks&) const = default;
+
+ private:
+  constexpr explicit TimeTicks(int64_t us) : us_(us) {}
+
+  int64_t us_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_TIME_TIME_H_
@@ -0,0 +1,163 @@
+#ifndef BASE_TYPES_EXPECTED_H_
+#define BASE_TYPES_EXPECTED_H_
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "base/check.h"
+
+namespace base {
+
+// Wraps an error to construct an `expected` holding it:
+//
+//   base::expected<int, Error> Parse(std::string_view input) {
+//     if (input.empty()) {
+//       return base::unexpected(Error::kEmpty);
+//     }
+//     return 42;
+//   }
+template <typename E>
+class unexpected {
+ public:
+  constexpr explicit unexpected(E error) : error_(std::move(error)) {}
+
+  constexpr E& error() & { return error_; }
+  constexpr const E& error() const& { return error_; }
+  constexpr E&& error() && { return std::move(error_); }
+
+ private:
+  E error_;
+};
+
+template <typename E>
+unexpected(E) -> unexpected<E>;
+
+// Tags the constructor of an `expected` that constructs its error in place.
+struct unexpect_t {
+  explicit unexpect_t() = default;
+};
+inline constexpr unexpect_t unexpect{};
+
+// A subset of C++23's `std::expected`: holds either a value of type `T` or an
+// error of type `E`. `T` may be `void`. Accessing the value of an `expected`
+// that holds an error, or the reverse, is a CHECK failure.
+template <typename T, typename E>
+class expected {
+ public:
+  using value_type = T;
+  using error_type = E;
+
+  constexpr expected()
+    requires(std::is_default_constructible_v<T>)
+      : storage_(std::in_place_index<0>) {}
+
+  template <typename U = T>
+    requires(std::is_constructible_v<T, U &&> &&
+             !std::is_same_v<std::remove_cvref_t<U>, expected>)
+  constexpr expected(U&& value)
+      : storage_(std::in_place_index<0>, std::forward<U>(value)) {}
+
+  template <typename G>
+    requires(std::is_constructible_v<E, G &&>)
+  constexpr expected(unexpected<G> error)
+      : storage_(std::in_place_index<1>, std::move(error).error()) {}
+
+  template <typename... Args>
+  constexpr explicit expected(unexpect_t, Args&&... args)
+      : storage_(std::in_place_index<1>, std::forward<Args>(args)...) {}
+
+  constexpr bool has_value() const { return storage_.index() == 0; }
+  constexpr explicit operator bool() const { return has_value(); }
+
+  constexpr T& value() & {
+    CHECK(has_value());
+    return *std::get_if<0>(&storage_);
+  }
+  constexpr const T& value() const& {
+    CHECK(has_value());
+    return *std::get_if<0>(&storage_);
+  }
+  constexpr T&& value() && { return std::move(value()); }
+
+  constexpr E& error() & {
+    CHECK(!has_value());
+    return *std::get_if<1>(&storage_);
+  }
+  constexpr const E& error() const& {
+    CHECK(!has_value());
+    return *std::get_if<1>(&storage_);
+  }
+  constexpr E&& error() && { return std::move(error()); }
+
+  constexpr T& operator*() & { return value(); }
+  constexpr const T& operator*() const& { return value(); }
+  constexpr T&& operator*() && { return std::move(value()); }
+  constexpr T* operator->() { return &value(); }
+  constexpr const T* operator->() const { return &value(); }
+
+  template <typename U>
+  constexpr T value_or(U&& default_value) const& {
+    return has_value() ? value() : T(std::forward<U>(default_value));
+  }
+  template <typename U>
+  constexpr T value_or(U&& default_value) && {
+    return has_value() ? std::move(value()) : T(std::forward<U>(default_value));
+  }
+
+ private:
+  std::variant<T, E> storage_;
+};
+
+template <typename E>
+class expected<void, E> {
+ public:
+  using value_type = void;
+  using error_type = E;
+
+  constexpr expected() = default;
+
+  template <typename G>
+    requires(std::is_constructible_v<E, G &&>)
+  constexpr expected(unexpected<G> error)
+      : storage_(std::in_place_index<1>, std::move(error).error()) {}
+
+  template <typename... Args>
+  constexpr explicit expected(unexpect_t, Args&&... args)
+      : storage_(std::in_place_index<1>, std::forward<Args>(args)...) {}
+
+  constexpr bool has_value() const { return storage_.index() == 0; }
+  constexpr explicit operator bool() const { return has_value(); }
+
+  constexpr void value() const { CHECK(has_value()); }
+
+  constexpr E& error() & {
+    CHECK(!has_value());
+    return *std::get_if<1>(&storage_);
+  }
+  constexpr const E& error() const& {
+    CHECK(!has_value());
+    return *std::get_if<1>(&storage_);
+  }
+  constexpr E&& error() && { return std::move(error()); }
+
+ private:
+  std::variant<std::monostate, E> storage_;
+};
+
+namespace internal {
+
+template <typename T>
+struct IsExpectedImpl : std::false_type {};
+
+template <typename T, typename E>
+struct IsExpectedImpl<expected<T, E>> : std::true_type {};
+
+template <typename T>
+concept IsExpected = IsExpectedImpl<T>::value;
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_TYPES_EXPECTED_H_
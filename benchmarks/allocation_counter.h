@@ -0,0 +1,15 @@
+#ifndef BENCHMARKS_ALLOCATION_COUNTER_H_
+#define BENCHMARKS_ALLOCATION_COUNTER_H_
+
+#include <cstdint>
+
+namespace benchmarks {
+
+// Returns the number of calls to the global `operator new` (in all of its
+// forms) made by any thread since the process started. Linking
+// allocation_counter.cc replaces the global allocation functions.
+int64_t GetAllocationCount();
+
+}  // namespace benchmarks
+
+#endif  // BENCHMARKS_ALLOCATION_COUNTER_H_
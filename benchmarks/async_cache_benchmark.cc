@@ -0,0 +1,223 @@
+// Benchmarks for `AsyncLruCache`: the cost of a hit, and duplicate concurrent
+// requests for one resource with and without single-flight loading.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/futures/async_lru_cache.h"
+#include "base/futures/future.h"
+#include "base/location.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/time/time.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+// Components that ask for the same resource at about the same time.
+constexpr int kConcurrentRequests = 16;
+
+constexpr int kCachedResources = 1000;
+
+// A backend that holds on to loads until told to answer them.
+class Backend {
+ public:
+  Backend() {
+    pending_.reserve(kConcurrentRequests);
+    answering_.reserve(kConcurrentRequests);
+  }
+
+  base::Future<int> Load(int resource) {
+    ++num_loads_;
+    pending_.emplace_back();
+    resources_.push_back(resource);
+    return pending_.back().GetFuture();
+  }
+
+  // Answers the pending loads in a task, as replies from another process
+  // would arrive.
+  void AnswerAll() {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&Backend::AnswerPending, this));
+    base::RunLoop().RunUntilIdle();
+  }
+
+  int64_t num_loads() const { return num_loads_; }
+
+ private:
+  void AnswerPending() {
+    answering_.swap(pending_);
+    for (size_t i = 0; i < answering_.size(); ++i) {
+      answering_[i].SetValue(resources_[i]);
+    }
+    answering_.clear();
+    resources_.clear();
+  }
+
+  std::vector<base::Promise<int>> pending_;
+  std::vector<base::Promise<int>> answering_;
+  std::vector<int> resources_;
+  int64_t num_loads_ = 0;
+};
+
+class Receiver {
+ public:
+  void OnValue(int value) { sum_ += value; }
+
+ private:
+  int64_t sum_ = 0;
+};
+
+std::string GetLoadsLabel(const benchmarks::State& state,
+                          const Backend& backend) {
+  return "backend loads per iteration " +
+         std::to_string(backend.num_loads() / state.iterations());
+}
+
+// A lookup of a loaded value returns a ready future, with nothing to
+// allocate or post.
+void BM_AsyncLruCacheHit(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  base::AsyncLruCache<int, int> cache(kCachedResources);
+  for (int i = 0; i < kCachedResources; ++i) {
+    cache.Get(i, [i] { return base::MakeReadyFuture(i); });
+  }
+  Receiver receiver;
+  int next = 0;
+  for (auto _ : state) {
+    receiver.OnValue(
+        cache.Get(next, [] { return base::MakeReadyFuture(0); })
+            .GetValueSynchronously());
+    next = next + 1 == kCachedResources ? 0 : next + 1;
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_AsyncLruCacheHit, 0, 0);
+
+struct RequestContext {
+  Backend* backend;
+  Receiver* receiver;
+  base::AsyncLruCache<int, int>* cache;
+};
+
+void RequestUncached(RequestContext* context) {
+  for (int i = 0; i < kConcurrentRequests; ++i) {
+    context->backend->Load(1).AndThen(
+        [receiver = context->receiver](int value) {
+          receiver->OnValue(value);
+        });
+  }
+}
+
+// Every component loads the resource itself.
+void BM_DuplicateLoadsUncached(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Backend backend;
+  Receiver receiver;
+  RequestContext context{&backend, &receiver, nullptr};
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&RequestUncached, &context));
+    backend.AnswerAll();
+  }
+  state.SetLabel(GetLoadsLabel(state, backend));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_DuplicateLoadsUncached, 2, 2);
+
+void RequestThroughCache(RequestContext* context) {
+  // Start each iteration with a miss.
+  context->cache->Clear();
+  for (int i = 0; i < kConcurrentRequests; ++i) {
+    context->cache
+        ->Get(1, [backend = context->backend] { return backend->Load(1); })
+        .AndThen([receiver = context->receiver](int value) {
+          receiver->OnValue(value);
+        });
+  }
+}
+
+// The first request loads the resource and the others join its load. The
+// cache entry and its shared state are allocated per load, and the joins'
+// frames are recycled.
+void BM_DuplicateLoadsSingleFlight(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Backend backend;
+  Receiver receiver;
+  base::AsyncLruCache<int, int> cache(kCachedResources);
+  RequestContext context{&backend, &receiver, &cache};
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&RequestThroughCache, &context));
+    backend.AnswerAll();
+  }
+  state.SetLabel(GetLoadsLabel(state, backend));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_DuplicateLoadsSingleFlight, 4, 2);
+
+constexpr base::TimeDelta kShortTtl = base::Microseconds(1);
+
+// Spins until `delta` has passed, for entries to expire.
+void WaitPast(base::TimeDelta delta) {
+  const base::TimeTicks end = base::TimeTicks::Now() + delta;
+  while (base::TimeTicks::Now() <= end) {
+  }
+}
+
+// As above, but with a load that takes longer than the entry's TTL, and with
+// the requests made directly rather than from a posted task. The requests
+// that arrive once the TTL has passed still join the load in flight, rather
+// than starting their own.
+void BM_SlowLoadSingleFlight(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Backend backend;
+  Receiver receiver;
+  base::AsyncLruCache<int, int> cache(kCachedResources, kShortTtl);
+  auto load = [&backend] { return backend.Load(1); };
+  auto on_value = [&receiver](int value) { receiver.OnValue(value); };
+  for (auto _ : state) {
+    cache.Clear();
+    const int64_t num_loads = backend.num_loads();
+    cache.Get(1, load).AndThen(on_value);
+    WaitPast(kShortTtl);
+    for (int i = 1; i < kConcurrentRequests; ++i) {
+      cache.Get(1, load).AndThen(on_value);
+    }
+    CHECK(backend.num_loads() == num_loads + 1);
+    backend.AnswerAll();
+  }
+  state.SetLabel(GetLoadsLabel(state, backend));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_SlowLoadSingleFlight, 3, 1);
+
+constexpr int kExpiringResources = 16;
+
+// Long enough that an entry inserted by a lookup does not expire before the
+// lookup returns, even in a sanitizer build.
+constexpr base::TimeDelta kExpiringTtl = base::Milliseconds(1);
+
+// Entries that expire unused. Inserting a new entry, or trimming the cache,
+// evicts them, even though the cache is far from full.
+void BM_AsyncLruCacheExpiredEviction(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  base::AsyncLruCache<int, int> cache(kCachedResources, kExpiringTtl);
+  for (auto _ : state) {
+    for (int i = 0; i < kExpiringResources; ++i) {
+      cache.Get(i, [i] { return base::MakeReadyFuture(i); });
+    }
+    WaitPast(kExpiringTtl);
+    cache.Get(kExpiringResources, [] { return base::MakeReadyFuture(0); });
+    CHECK(cache.size() == 1);
+    WaitPast(kExpiringTtl);
+    cache.Trim(kCachedResources);
+    CHECK(cache.size() == 0);
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_AsyncLruCacheExpiredEviction,
+                              2 * (kExpiringResources + 1),
+                              0);
+
+}  // namespace
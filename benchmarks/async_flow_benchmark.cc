@@ -0,0 +1,183 @@
+// Runs the README's three-step `AsyncClass::PerformAsyncAction` flow in each
+// of its three forms: `BindOnce` + `WeakPtr` member callbacks, `AndThen`
+// chains, and a coroutine. Each step is served by a simulated backend that
+// completes in a later task, so every form pays for the same three
+// asynchronous completions and the differences are the cost of composing
+// them.
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/futures/future.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+struct StepOneValue {
+  int value;
+};
+
+struct StepTwoValue {
+  int value;
+};
+
+// The simulated backend, in callback and future flavors.
+template <typename T>
+void CompleteLater(base::OnceCallback<void(T)> callback, T value) {
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(std::move(callback), std::move(value)));
+}
+
+template <typename T>
+base::Future<T> CompleteLater(T value) {
+  base::Promise<T> promise;
+  base::Future<T> future = promise.GetFuture();
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(
+                     [](base::Promise<T> promise, T value) {
+                       promise.SetValue(std::move(value));
+                     },
+                     std::move(promise), std::move(value)));
+  return future;
+}
+
+class ResultSink {
+ public:
+  base::WeakPtr<ResultSink> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  void OnResult(int result) { sum_ += result; }
+
+ private:
+  long long sum_ = 0;
+  base::WeakPtrFactory<ResultSink> weak_factory_{this};
+};
+
+// The callback form.
+class CallbackAsyncClass {
+ public:
+  void PerformAsyncAction(base::OnceCallback<void(int)> callback) {
+    CompleteLater(
+        base::BindOnce(&CallbackAsyncClass::OnAsyncStepOneCompleted,
+                       weak_factory_.GetWeakPtr(), std::move(callback)),
+        StepOneValue{1});
+  }
+
+ private:
+  void OnAsyncStepOneCompleted(base::OnceCallback<void(int)> callback,
+                               StepOneValue value) {
+    CompleteLater(
+        base::BindOnce(&CallbackAsyncClass::OnAsyncStepTwoCompleted,
+                       weak_factory_.GetWeakPtr(), std::move(callback)),
+        StepTwoValue{value.value + 1});
+  }
+
+  void OnAsyncStepTwoCompleted(base::OnceCallback<void(int)> callback,
+                               StepTwoValue value) {
+    CompleteLater(
+        base::BindOnce(&CallbackAsyncClass::OnAsyncStepThreeCompleted,
+                       weak_factory_.GetWeakPtr(), std::move(callback)),
+        value.value + 1);
+  }
+
+  void OnAsyncStepThreeCompleted(base::OnceCallback<void(int)> callback,
+                                 int value) {
+    std::move(callback).Run(value);
+  }
+
+  base::WeakPtrFactory<CallbackAsyncClass> weak_factory_{this};
+};
+
+// The `AndThen` chain form.
+class FutureChainAsyncClass {
+ public:
+  base::Future<int> PerformAsyncAction() {
+    return CompleteLater(StepOneValue{1})
+        .AndThen(base::BindOnce(&FutureChainAsyncClass::OnAsyncStepOneCompleted,
+                                weak_factory_.GetWeakPtr()))
+        .AndThen(base::BindOnce(&FutureChainAsyncClass::OnAsyncStepTwoCompleted,
+                                weak_factory_.GetWeakPtr()));
+  }
+
+ private:
+  static base::Future<StepTwoValue> OnAsyncStepOneCompleted(
+      base::WeakPtr<FutureChainAsyncClass> self,
+      StepOneValue value) {
+    if (!self) {
+      return {};
+    }
+    return CompleteLater(StepTwoValue{value.value + 1});
+  }
+
+  static base::Future<int> OnAsyncStepTwoCompleted(
+      base::WeakPtr<FutureChainAsyncClass> self,
+      StepTwoValue value) {
+    if (!self) {
+      return {};
+    }
+    return CompleteLater(value.value + 1);
+  }
+
+  base::WeakPtrFactory<FutureChainAsyncClass> weak_factory_{this};
+};
+
+// The coroutine form.
+class CoroutineAsyncClass {
+ public:
+  base::WeakPtr<CoroutineAsyncClass> AsWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  base::Future<int> PerformAsyncAction() {
+    StepOneValue step_1_value = co_await CompleteLater(StepOneValue{1});
+    StepTwoValue step_2_value =
+        co_await CompleteLater(StepTwoValue{step_1_value.value + 1});
+    co_return CompleteLater(step_2_value.value + 1);
+  }
+
+ private:
+  base::WeakPtrFactory<CoroutineAsyncClass> weak_factory_{this};
+};
+
+void BM_AsyncFlowCallbacks(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  CallbackAsyncClass async_class;
+  ResultSink sink;
+  for (auto _ : state) {
+    async_class.PerformAsyncAction(
+        base::BindOnce(&ResultSink::OnResult, sink.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_AsyncFlowCallbacks, 7, 3);
+
+void BM_AsyncFlowFutureChain(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  FutureChainAsyncClass async_class;
+  ResultSink sink;
+  for (auto _ : state) {
+    async_class.PerformAsyncAction().AndThen(
+        base::BindOnce(&ResultSink::OnResult, sink.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_AsyncFlowFutureChain, 10, 3);
+
+void BM_AsyncFlowCoroutine(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  CoroutineAsyncClass async_class;
+  ResultSink sink;
+  for (auto _ : state) {
+    async_class.PerformAsyncAction().AndThen(
+        base::BindOnce(&ResultSink::OnResult, sink.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_AsyncFlowCoroutine, 5, 3);
+
+}  // namespace
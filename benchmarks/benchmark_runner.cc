@@ -0,0 +1,164 @@
+#include "benchmarks/benchmark_runner.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/task/task_queue.h"
+#include "benchmarks/allocation_counter.h"
+
+namespace benchmarks {
+
+namespace {
+
+struct Benchmark {
+  const char* name;
+  BenchmarkFunction function;
+  Budget budget;
+};
+
+std::vector<Benchmark>& GetRegistry() {
+  static std::vector<Benchmark> registry;
+  return registry;
+}
+
+constexpr std::chrono::milliseconds kDefaultMinTime{200};
+constexpr int64_t kMaxIterations = int64_t{1} << 30;
+constexpr int64_t kBudgetCheckIterations = 1000;
+
+int64_t GetPostedTaskCount() {
+  base::internal::TaskQueue* task_queue =
+      base::internal::TaskQueue::GetCurrent();
+  return task_queue ? static_cast<int64_t>(task_queue->GetNumPostedTasks())
+                    : 0;
+}
+
+double PerIteration(int64_t total, const State& state) {
+  return static_cast<double>(total) / static_cast<double>(state.iterations());
+}
+
+// Runs `benchmark` with a growing iteration count until a run takes at least
+// `min_time`, and returns that run.
+State RunBenchmark(const Benchmark& benchmark,
+                   std::chrono::nanoseconds min_time) {
+  int64_t iterations = 1;
+  while (true) {
+    State state(iterations);
+    benchmark.function(state);
+    if (state.elapsed() >= min_time || iterations >= kMaxIterations) {
+      return state;
+    }
+    // Aim slightly past `min_time`, growing at most 10x per step.
+    double elapsed = static_cast<double>(state.elapsed().count());
+    double multiplier = elapsed > 0 ? 1.4 * min_time.count() / elapsed : 10.0;
+    if (multiplier > 10.0) {
+      multiplier = 10.0;
+    }
+    int64_t next = static_cast<int64_t>(iterations * multiplier);
+    iterations = next > iterations ? next : iterations + 1;
+  }
+}
+
+bool Matches(const Benchmark& benchmark, const std::string& filter) {
+  return filter.empty() ||
+         std::string(benchmark.name).find(filter) != std::string::npos;
+}
+
+int CheckBudgets(const std::string& filter) {
+  int failures = 0;
+  for (const Benchmark& benchmark : GetRegistry()) {
+    const Budget& budget = benchmark.budget;
+    if (!Matches(benchmark, filter) ||
+        (budget.max_allocations < 0 && budget.max_posted_tasks < 0)) {
+      continue;
+    }
+    // Subtract a run of N iterations from a run of 2N, so that one-time
+    // costs such as container growth cancel out.
+    State short_run(kBudgetCheckIterations);
+    benchmark.function(short_run);
+    State long_run(2 * kBudgetCheckIterations);
+    benchmark.function(long_run);
+    double allocations =
+        static_cast<double>(long_run.allocations() - short_run.allocations()) /
+        kBudgetCheckIterations;
+    double posted_tasks =
+        static_cast<double>(long_run.posted_tasks() - short_run.posted_tasks()) /
+        kBudgetCheckIterations;
+    bool ok = (budget.max_allocations < 0 ||
+               allocations <= budget.max_allocations) &&
+              (budget.max_posted_tasks < 0 ||
+               posted_tasks <= budget.max_posted_tasks);
+    std::printf("%-4s %-48s allocs %6.2f (max %6.2f)  tasks %6.2f (max %6.2f)\n",
+                ok ? "OK" : "FAIL", benchmark.name, allocations,
+                budget.max_allocations, posted_tasks, budget.max_posted_tasks);
+    if (!ok) {
+      ++failures;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+void State::StartMeasuring() {
+  start_allocations_ = GetAllocationCount();
+  start_posted_tasks_ = GetPostedTaskCount();
+  start_ = std::chrono::steady_clock::now();
+}
+
+void State::StopMeasuring() {
+  elapsed_ = std::chrono::steady_clock::now() - start_;
+  allocations_ = GetAllocationCount() - start_allocations_;
+  posted_tasks_ = GetPostedTaskCount() - start_posted_tasks_;
+}
+
+Registration::Registration(const char* name,
+                           BenchmarkFunction function,
+                           Budget budget) {
+  GetRegistry().push_back({name, function, budget});
+}
+
+int RunRegisteredBenchmarks(int argc, char** argv) {
+  std::string filter;
+  std::chrono::nanoseconds min_time = kDefaultMinTime;
+  bool check_budgets = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (std::strncmp(argv[i], "--min_time_ms=", 14) == 0) {
+      min_time = std::chrono::milliseconds(std::atoi(argv[i] + 14));
+    } else if (std::strcmp(argv[i], "--check_budgets") == 0) {
+      check_budgets = true;
+    } else {
+      std::fprintf(stderr,
+                   "Usage: %s [--filter=<substring>] [--min_time_ms=<ms>] "
+                   "[--check_budgets]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  if (check_budgets) {
+    return CheckBudgets(filter);
+  }
+
+  std::printf("%-48s %12s %12s %10s %10s\n", "Benchmark", "Iterations",
+              "ns/iter", "allocs", "tasks");
+  for (const Benchmark& benchmark : GetRegistry()) {
+    if (!Matches(benchmark, filter)) {
+      continue;
+    }
+    State state = RunBenchmark(benchmark, min_time);
+    std::printf("%-48s %12lld %12.1f %10.2f %10.2f  %s\n", benchmark.name,
+                static_cast<long long>(state.iterations()),
+                PerIteration(state.elapsed().count(), state),
+                PerIteration(state.allocations(), state),
+                PerIteration(state.posted_tasks(), state),
+                state.label().c_str());
+  }
+  return 0;
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,124 @@
+#ifndef BENCHMARKS_BENCHMARK_RUNNER_H_
+#define BENCHMARKS_BENCHMARK_RUNNER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace benchmarks {
+
+// Handed to each benchmark function. The function performs any setup, then
+// runs the measured operation once per iteration of a range-for over the
+// state; only the loop itself is measured.
+//
+//   void BM_Something(benchmarks::State& state) {
+//     Setup();
+//     for (auto _ : state) {
+//       DoSomething();
+//     }
+//   }
+//
+// Besides wall time, the loop records the number of heap allocations made by
+// any thread and the number of tasks posted to the current thread's
+// `SingleThreadTaskExecutor`.
+class State {
+ public:
+  // The loop variable type. Marked unused so that `for (auto _ : state)`
+  // does not warn.
+  struct __attribute__((unused)) Value {};
+
+  class Iterator {
+   public:
+    explicit Iterator(State* state, int64_t remaining)
+        : state_(state), remaining_(remaining) {}
+
+    Value operator*() const { return Value(); }
+    Iterator& operator++() {
+      --remaining_;
+      return *this;
+    }
+    bool operator!=(const Iterator&) {
+      if (remaining_ > 0) {
+        return true;
+      }
+      state_->StopMeasuring();
+      return false;
+    }
+
+   private:
+    State* state_;
+    int64_t remaining_;
+  };
+
+  explicit State(int64_t iterations) : iterations_(iterations) {}
+
+  int64_t iterations() const { return iterations_; }
+
+  Iterator begin() {
+    StartMeasuring();
+    return Iterator(this, iterations_);
+  }
+  Iterator end() { return Iterator(this, 0); }
+
+  std::chrono::nanoseconds elapsed() const { return elapsed_; }
+  int64_t allocations() const { return allocations_; }
+  int64_t posted_tasks() const { return posted_tasks_; }
+
+  // Sets free-form text printed after the measurements, e.g. a hit rate.
+  void SetLabel(std::string label) { label_ = std::move(label); }
+  const std::string& label() const { return label_; }
+
+ private:
+  void StartMeasuring();
+  void StopMeasuring();
+
+  const int64_t iterations_;
+  std::chrono::steady_clock::time_point start_;
+  int64_t start_allocations_ = 0;
+  int64_t start_posted_tasks_ = 0;
+  std::chrono::nanoseconds elapsed_{0};
+  int64_t allocations_ = 0;
+  int64_t posted_tasks_ = 0;
+  std::string label_;
+};
+
+using BenchmarkFunction = void (*)(State&);
+
+// Upper bounds on the per-iteration cost of a benchmark, enforced by
+// `--check_budgets`. Negative values are not checked.
+struct Budget {
+  double max_allocations = -1;
+  double max_posted_tasks = -1;
+};
+
+// Registers a benchmark during static initialization. Use through
+// `FUTURES_BENCHMARK` or `FUTURES_BENCHMARK_WITH_BUDGET`.
+class Registration {
+ public:
+  Registration(const char* name, BenchmarkFunction function, Budget budget);
+};
+
+// Runs all registered benchmarks whose name contains the `--filter=`
+// argument, if any, and prints one line per benchmark. With
+// `--check_budgets`, instead runs each benchmark that has a budget for a
+// fixed number of iterations and fails if any exceeds it. Returns the process
+// exit code.
+int RunRegisteredBenchmarks(int argc, char** argv);
+
+}  // namespace benchmarks
+
+#define FUTURES_BENCHMARK(function)                               \
+  static const ::benchmarks::Registration function##_registration( \
+      #function, &function, ::benchmarks::Budget())
+
+// Registers a benchmark whose allocations and posted tasks per iteration must
+// not exceed the given bounds. The bounds act as a regression gate: tighten
+// them when a change makes the benchmarked operation cheaper.
+#define FUTURES_BENCHMARK_WITH_BUDGET(function, max_allocations,   \
+                                      max_posted_tasks)            \
+  static const ::benchmarks::Registration function##_registration( \
+      #function, &function,                                        \
+      ::benchmarks::Budget{max_allocations, max_posted_tasks})
+
+#endif  // BENCHMARKS_BENCHMARK_RUNNER_H_
@@ -0,0 +1,94 @@
+// Benchmarks for cancelling many pending timeouts at once, as a client would
+// when the requests they guard are abandoned together, comparing
+// `CancellationSource` with the weak-pointer cancel token shown in the
+// README.
+
+#include <string>
+#include <utility>
+
+#include "base/functional/callback.h"
+#include "base/futures/cancellation.h"
+#include "base/futures/delay.h"
+#include "base/futures/future.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/task/task_queue.h"
+#include "base/task/timer_wheel.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+constexpr int kPendingTimeouts = 100;
+
+// Long enough that no timeout comes due during a run, so that any timer
+// still queued at the end was left behind by cancellation.
+constexpr base::TimeDelta kTimeout = base::Seconds(60);
+
+size_t GetNumQueuedTimers() {
+  return base::internal::TaskQueue::GetCurrent()->GetNumDelayedTasks();
+}
+
+size_t GetNumPendingWheelTimers() {
+  return base::TimerWheel::GetForCurrentSequence().GetNumTimers();
+}
+
+base::Future<void> AwaitTimeout(const base::CancellationToken& token) {
+  co_await base::Delay(kTimeout, token);
+}
+
+// Cancelling the source destroys each suspended coroutine and unlinks its
+// timer from the sequence's timer wheel, freeing the timer's state. Frames
+// are recycled, so each timeout costs only its state. The wheel's wake-up
+// task, posted for the first timer, stays queued for later ones.
+void BM_CancellationSourceStorm(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    base::CancellationSource source;
+    for (int i = 0; i < kPendingTimeouts; ++i) {
+      AwaitTimeout(source.token());
+    }
+    source.Cancel();
+  }
+  state.SetLabel("pending timers " +
+                 std::to_string(GetNumPendingWheelTimers()));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CancellationSourceStorm,
+                              kPendingTimeouts + 1,
+                              0);
+
+// The cancel token from the README, and the `Delay` built on `MakeFuture`.
+struct CancelToken {
+  auto AsWeakPtr() const { return weak_ptr_factory.GetWeakPtr(); }
+  base::WeakPtrFactory<const CancelToken> weak_ptr_factory{this};
+};
+
+base::Future<void> DelayWithoutCancellation(base::TimeDelta delta) {
+  return base::MakeFuture<void>([delta](base::OnceClosure callback) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostDelayedTask(
+        FROM_HERE, std::move(callback), delta);
+  });
+}
+
+base::Future<void> AwaitTimeoutWithCancelToken(const CancelToken&) {
+  co_await DelayWithoutCancellation(kTimeout);
+}
+
+// Destroying the token destroys the coroutines, but their timers stay queued
+// until they come due. For comparison only: the queue grows with every
+// iteration.
+void BM_CancelTokenStorm(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    CancelToken token;
+    for (int i = 0; i < kPendingTimeouts; ++i) {
+      AwaitTimeoutWithCancelToken(token);
+    }
+  }
+  state.SetLabel("queued timers " + std::to_string(GetNumQueuedTimers()));
+}
+FUTURES_BENCHMARK(BM_CancelTokenStorm);
+
+}  // namespace
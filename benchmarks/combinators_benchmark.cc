@@ -0,0 +1,421 @@
+// Benchmarks for the future combinators in `base/futures/`, alongside the
+// hand-written `AndThen` patterns they replace. Fan-outs are resolved within
+// a task, as backend replies would be, so that the measured cost is that of
+// combining the futures rather than of delivering each value.
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/futures/delay.h"
+#include "base/futures/for_each_async.h"
+#include "base/futures/future.h"
+#include "base/futures/when_all.h"
+#include "base/futures/when_any.h"
+#include "base/futures/with_timeout.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/task/timer_wheel.h"
+#include "base/time/time.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+constexpr int kFanOut = 100;
+
+// The number of requests a windowed fan-out keeps pending at a time.
+constexpr size_t kMaxInFlight = 10;
+
+// Long enough that no timeout expires during a run.
+constexpr base::TimeDelta kRequestTimeout = base::Seconds(60);
+
+class Receiver {
+ public:
+  base::WeakPtr<Receiver> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  void OnValue(int value) { sum_ += value; }
+
+  void OnValues(std::vector<int> values) {
+    for (int value : values) {
+      sum_ += value;
+    }
+  }
+
+  int64_t sum() const { return sum_; }
+
+ private:
+  int64_t sum_ = 0;
+  base::WeakPtrFactory<Receiver> weak_factory_{this};
+};
+
+// Runs `fn` with `receiver` in a posted task, and waits for it.
+void RunInTask(void (*fn)(Receiver*), Receiver& receiver) {
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(fn, &receiver));
+  base::RunLoop().RunUntilIdle();
+}
+
+// The hand-written fan-in: a counter object, and one bound callback per
+// input.
+class FanInCollector {
+ public:
+  FanInCollector(Receiver* receiver, int count)
+      : receiver_(receiver->AsWeakPtr()), values_(count), remaining_(count) {}
+
+  void OnValue(size_t index, int value) {
+    values_[index] = value;
+    if (--remaining_ == 0) {
+      if (receiver_) {
+        receiver_->OnValues(std::move(values_));
+      }
+      delete this;
+    }
+  }
+
+ private:
+  base::WeakPtr<Receiver> receiver_;
+  std::vector<int> values_;
+  int remaining_;
+};
+
+void FanInWithAndThen(Receiver* receiver) {
+  std::vector<base::Promise<int>> promises(kFanOut);
+  auto* collector = new FanInCollector(receiver, kFanOut);
+  for (size_t i = 0; i < promises.size(); ++i) {
+    promises[i].GetFuture().AndThen(
+        base::BindOnce(&FanInCollector::OnValue, collector, i));
+  }
+  for (base::Promise<int>& promise : promises) {
+    promise.SetValue(1);
+  }
+}
+
+void BM_FanInAndThen(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    RunInTask(&FanInWithAndThen, receiver);
+  }
+  CHECK(receiver.sum() == state.iterations() * kFanOut);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_FanInAndThen, kFanOut + 4, 1);
+
+void FanInWithWhenAll(Receiver* receiver) {
+  std::vector<base::Promise<int>> promises(kFanOut);
+  std::vector<base::Future<int>> futures;
+  futures.reserve(promises.size());
+  for (base::Promise<int>& promise : promises) {
+    futures.push_back(promise.GetFuture());
+  }
+  base::WhenAll(std::move(futures))
+      .AndThen([receiver = receiver->AsWeakPtr()](std::vector<int> values) {
+        if (receiver) {
+          receiver->OnValues(std::move(values));
+        }
+      });
+  for (base::Promise<int>& promise : promises) {
+    promise.SetValue(1);
+  }
+}
+
+// `WhenAll` over a vector: one shared state and one results buffer, however
+// many futures there are.
+void BM_FanInWhenAll(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    RunInTask(&FanInWithWhenAll, receiver);
+  }
+  CHECK(receiver.sum() == state.iterations() * kFanOut);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_FanInWhenAll, 5, 1);
+
+void WhenAllOfThree(Receiver* receiver) {
+  base::Promise<int> first;
+  base::Promise<int> second;
+  base::WhenAll(first.GetFuture(), second.GetFuture(),
+                base::MakeReadyFuture(1))
+      .AndThen([receiver = receiver->AsWeakPtr()](
+                   std::tuple<int, int, int> values) {
+        if (receiver) {
+          receiver->OnValue(std::get<0>(values) + std::get<1>(values) +
+                            std::get<2>(values));
+        }
+      });
+  first.SetValue(1);
+  second.SetValue(1);
+}
+
+// The variadic form, whose only allocation is its shared state.
+void BM_WhenAllTuple(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    RunInTask(&WhenAllOfThree, receiver);
+  }
+  CHECK(receiver.sum() == state.iterations() * 3);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WhenAllTuple, 2, 1);
+
+// A request to a backend that has not answered yet.
+base::Future<int> AwaitBackend(base::Future<int> reply) {
+  int value = co_await std::move(reply);
+  co_return value + 1;
+}
+
+void HedgedRequest(Receiver* receiver) {
+  base::Promise<int> slow;
+  base::Promise<int> fast;
+  base::WhenAny(AwaitBackend(slow.GetFuture()), fast.GetFuture())
+      .AndThen([receiver = receiver->AsWeakPtr()](
+                   std::variant<int, int> value) {
+        if (receiver) {
+          receiver->OnValue(std::get<1>(value));
+        }
+      });
+  fast.SetValue(1);
+}
+
+// A hedged request whose losing branch is a suspended coroutine. Abandoning
+// it destroys the frame at once, so the frame is recycled on the next
+// iteration and, besides the task, the only allocation is the race's shared
+// state.
+void BM_WhenAnyHedgedCoroutine(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    RunInTask(&HedgedRequest, receiver);
+  }
+  CHECK(receiver.sum() == state.iterations());
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WhenAnyHedgedCoroutine, 2, 1);
+
+void RequestWithTimeout(Receiver* receiver) {
+  base::Promise<int> reply;
+  base::WithTimeout(reply.GetFuture(), kRequestTimeout)
+      .AndThen([receiver = receiver->AsWeakPtr()](std::optional<int> value) {
+        if (receiver && value) {
+          receiver->OnValue(*value);
+        }
+      });
+  reply.SetValue(1);
+}
+
+// A request answered before its timeout. The shared state, which is also the
+// timer, is the only allocation, and the reply unlinks the timer from the
+// wheel.
+void BM_WithTimeout(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    RunInTask(&RequestWithTimeout, receiver);
+  }
+  CHECK(receiver.sum() == state.iterations());
+  state.SetLabel(
+      "pending timers " +
+      std::to_string(base::TimerWheel::GetForCurrentSequence().GetNumTimers()));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WithTimeout, 2, 1);
+
+void RequestWithDelayRace(Receiver* receiver) {
+  base::Promise<int> reply;
+  base::WhenAny(reply.GetFuture(), base::Delay(kRequestTimeout))
+      .AndThen([receiver = receiver->AsWeakPtr()](
+                   std::variant<int, base::VoidFutureValue> value) {
+        if (receiver && value.index() == 0) {
+          receiver->OnValue(std::get<0>(value));
+        }
+      });
+  reply.SetValue(1);
+}
+
+// The same timeout as a race against `Delay`, which costs the race's state
+// and the delay's state.
+void BM_WhenAnyDelayTimeout(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    RunInTask(&RequestWithDelayRace, receiver);
+  }
+  CHECK(receiver.sum() == state.iterations());
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WhenAnyDelayTimeout, 3, 1);
+
+// A backend that holds on to requests until told to answer them, which it
+// does in a task, as replies from another process would arrive.
+class Backend {
+ public:
+  Backend() {
+    pending_.reserve(kFanOut);
+    answering_.reserve(kFanOut);
+  }
+
+  base::Future<int> Send(int /*request*/) {
+    ++num_sent_;
+    pending_.emplace_back();
+    return pending_.back().GetFuture();
+  }
+
+  // Drops the oldest pending request without answering it, as when its
+  // handler fails.
+  void DropOldest() { pending_.erase(pending_.begin()); }
+
+  int64_t num_sent() const { return num_sent_; }
+
+  // Answers every pending request, once per task, until none is left.
+  void AnswerAll() {
+    while (!pending_.empty()) {
+      base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+          FROM_HERE, base::BindOnce(&Backend::AnswerPending, AsWeakPtr()));
+      base::RunLoop().RunUntilIdle();
+    }
+  }
+
+ private:
+  base::WeakPtr<Backend> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  void AnswerPending() {
+    answering_.swap(pending_);
+    for (base::Promise<int>& promise : answering_) {
+      promise.SetValue(1);
+    }
+    answering_.clear();
+  }
+
+  std::vector<base::Promise<int>> pending_;
+  std::vector<base::Promise<int>> answering_;
+  int64_t num_sent_ = 0;
+  base::WeakPtrFactory<Backend> weak_factory_{this};
+};
+
+// The hand-written window: a counter object that sends the next request from
+// each reply's bound callback.
+class WindowedFanOut {
+ public:
+  WindowedFanOut(Backend* backend, Receiver* receiver, int count)
+      : backend_(backend),
+        receiver_(receiver->AsWeakPtr()),
+        values_(count),
+        remaining_(count) {}
+
+  void Start() {
+    for (size_t i = 0; i < kMaxInFlight; ++i) {
+      SendNext();
+    }
+  }
+
+ private:
+  void SendNext() {
+    if (next_ == values_.size()) {
+      return;
+    }
+    const size_t index = next_++;
+    backend_->Send(static_cast<int>(index))
+        .AndThen(base::BindOnce(&WindowedFanOut::OnValue, this, index));
+  }
+
+  void OnValue(size_t index, int value) {
+    values_[index] = value;
+    if (--remaining_ > 0) {
+      SendNext();
+      return;
+    }
+    if (receiver_) {
+      receiver_->OnValues(std::move(values_));
+    }
+    delete this;
+  }
+
+  Backend* backend_;
+  base::WeakPtr<Receiver> receiver_;
+  std::vector<int> values_;
+  size_t next_ = 0;
+  int remaining_;
+};
+
+std::vector<int> MakeRequests() {
+  std::vector<int> requests(kFanOut);
+  for (int i = 0; i < kFanOut; ++i) {
+    requests[i] = i;
+  }
+  return requests;
+}
+
+// Sends `kFanOut` requests, `kMaxInFlight` at a time, by hand. Each request
+// costs a bound callback, besides the backend's task per batch of replies.
+void BM_WindowedFanOutAndThen(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  Backend backend;
+  for (auto _ : state) {
+    (new WindowedFanOut(&backend, &receiver, kFanOut))->Start();
+    backend.AnswerAll();
+  }
+  CHECK(receiver.sum() == state.iterations() * kFanOut);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WindowedFanOutAndThen,
+                              kFanOut + kFanOut / kMaxInFlight + 2,
+                              kFanOut / kMaxInFlight);
+
+// The same with `ForEachAsync`. Besides the backend's tasks, the input, the
+// shared state and the results buffer are the only allocations, however many
+// requests there are.
+void BM_WindowedFanOutForEachAsync(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  Backend backend;
+  for (auto _ : state) {
+    base::ForEachAsync(MakeRequests(), kMaxInFlight,
+                       [&backend](int request) {
+                         return backend.Send(request);
+                       })
+        .AndThen([receiver = receiver.AsWeakPtr()](std::vector<int> values) {
+          if (receiver) {
+            receiver->OnValues(std::move(values));
+          }
+        });
+    backend.AnswerAll();
+  }
+  CHECK(receiver.sum() == state.iterations() * kFanOut);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WindowedFanOutForEachAsync,
+                              kFanOut / kMaxInFlight + 3,
+                              kFanOut / kMaxInFlight);
+
+// As above, but the backend drops the first request. Its result can never be
+// delivered, so no further request is sent, and the requests in flight are
+// answered for nothing.
+void BM_WindowedFanOutForEachAsyncBroken(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  Backend backend;
+  for (auto _ : state) {
+    base::ForEachAsync(MakeRequests(), kMaxInFlight,
+                       [&backend](int request) {
+                         return backend.Send(request);
+                       })
+        .AndThen([receiver = receiver.AsWeakPtr()](std::vector<int> values) {
+          if (receiver) {
+            receiver->OnValues(std::move(values));
+          }
+        });
+    backend.DropOldest();
+    const int64_t num_sent = backend.num_sent();
+    backend.AnswerAll();
+    CHECK(backend.num_sent() == num_sent);
+  }
+  // No result is ever delivered.
+  CHECK(receiver.sum() == 0);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_WindowedFanOutForEachAsyncBroken, 4, 1);
+
+}  // namespace
@@ -0,0 +1,237 @@
+// Benchmarks for resolving futures from a worker thread toward the main
+// sequence, as thread-pool jobs reporting back to a UI or IO sequence would.
+// The worker resolves a whole fan-out while the main thread waits, so that
+// every resolution lands in the same batch.
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/futures/cross_sequence_promise.h"
+#include "base/futures/future.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+constexpr int kFanOut = 100;
+
+// A thread that runs one function at a time on behalf of the main thread.
+class WorkerThread {
+ public:
+  WorkerThread() : thread_([this] { Run(); }) {}
+  WorkerThread(const WorkerThread&) = delete;
+  WorkerThread& operator=(const WorkerThread&) = delete;
+
+  ~WorkerThread() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      quit_ = true;
+    }
+    work_available_.notify_one();
+    thread_.join();
+  }
+
+  // Runs `fn(arg)` on the worker thread, and waits for it to return.
+  void RunAndWait(void (*fn)(void*), void* arg) {
+    std::unique_lock<std::mutex> lock(lock_);
+    fn_ = fn;
+    arg_ = arg;
+    work_available_.notify_one();
+    work_done_.wait(lock, [this] { return !fn_; });
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(lock_);
+    while (true) {
+      work_available_.wait(lock, [this] { return fn_ || quit_; });
+      if (quit_) {
+        return;
+      }
+      fn_(arg_);
+      fn_ = nullptr;
+      work_done_.notify_one();
+    }
+  }
+
+  std::mutex lock_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  void (*fn_)(void*) = nullptr;
+  void* arg_ = nullptr;
+  bool quit_ = false;
+  std::thread thread_;
+};
+
+struct FanIn {
+  WorkerThread* worker;
+  int64_t sum = 0;
+};
+
+void ResolveAll(void* promises) {
+  for (base::CrossSequencePromise<int>& promise :
+       *static_cast<std::vector<base::CrossSequencePromise<int>>*>(promises)) {
+    promise.SetValue(1);
+  }
+}
+
+// Runs `fn` with `fan_in` in a posted task, and waits for it and for the
+// deliveries it causes.
+void RunInTask(void (*fn)(FanIn*), FanIn& fan_in) {
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(fn, &fan_in));
+  base::RunLoop().RunUntilIdle();
+}
+
+void ResolveAfterContinuationsSet(FanIn* fan_in) {
+  std::vector<base::CrossSequencePromise<int>> promises(kFanOut);
+  for (base::CrossSequencePromise<int>& promise : promises) {
+    promise.GetFuture().AndThen([fan_in](int value) { fan_in->sum += value; });
+  }
+  fan_in->worker->RunAndWait(&ResolveAll, &promises);
+}
+
+// Continuations are attached before the worker resolves the promises, so the
+// values are delivered by a single task for the whole fan-out.
+void BM_CrossSequencePromiseFanIn(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  WorkerThread worker;
+  FanIn fan_in{&worker};
+  for (auto _ : state) {
+    RunInTask(&ResolveAfterContinuationsSet, fan_in);
+  }
+  CHECK(fan_in.sum == state.iterations() * kFanOut);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CrossSequencePromiseFanIn, kFanOut + 3, 2);
+
+void ResolveBeforeContinuationsSet(FanIn* fan_in) {
+  std::vector<base::CrossSequencePromise<int>> promises(kFanOut);
+  std::vector<base::Future<int>> futures;
+  futures.reserve(promises.size());
+  for (base::CrossSequencePromise<int>& promise : promises) {
+    futures.push_back(promise.GetFuture());
+  }
+  fan_in->worker->RunAndWait(&ResolveAll, &promises);
+  for (base::Future<int>& future : futures) {
+    std::move(future).AndThen([fan_in](int value) { fan_in->sum += value; });
+  }
+}
+
+// The worker resolves the promises before continuations are attached, so the
+// values are picked up on the main sequence without posting at all.
+void BM_CrossSequencePromiseResolvedFirst(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  WorkerThread worker;
+  FanIn fan_in{&worker};
+  for (auto _ : state) {
+    RunInTask(&ResolveBeforeContinuationsSet, fan_in);
+  }
+  CHECK(fan_in.sum == state.iterations() * kFanOut);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CrossSequencePromiseResolvedFirst,
+                              kFanOut + 3,
+                              1);
+
+// Labels `state` with the tasks posted per resolved future, not counting the
+// task that drives each iteration.
+void SetTasksPerFutureLabel(benchmarks::State& state) {
+  double tasks = static_cast<double>(state.posted_tasks() - state.iterations());
+  state.SetLabel("tasks/future " +
+                 std::to_string(tasks / (state.iterations() * kFanOut)));
+}
+
+// Callbacks for a worker to run, and the sum of the replies they send back.
+struct ReplyFanIn {
+  explicit ReplyFanIn(WorkerThread* worker) : worker(worker) {}
+
+  base::WeakPtr<ReplyFanIn> AsWeakPtr() { return weak_factory.GetWeakPtr(); }
+
+  void OnReply(int value) { sum += value; }
+
+  WorkerThread* const worker;
+  std::vector<base::OnceCallback<void(int)>> callbacks;
+  int64_t sum = 0;
+  base::WeakPtrFactory<ReplyFanIn> weak_factory{this};
+};
+
+void RunAllCallbacks(void* callbacks) {
+  for (base::OnceCallback<void(int)>& callback :
+       *static_cast<std::vector<base::OnceCallback<void(int)>>*>(callbacks)) {
+    std::move(callback).Run(1);
+  }
+}
+
+// Runs `fn` with `fan_in` in a posted task, and waits for it and for the
+// replies it causes.
+void RunInTask(void (*fn)(ReplyFanIn*), ReplyFanIn& fan_in) {
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(fn, &fan_in));
+  base::RunLoop().RunUntilIdle();
+}
+
+void PostReplies(ReplyFanIn* fan_in) {
+  base::scoped_refptr<base::SequencedTaskRunner> task_runner =
+      base::SequencedTaskRunner::GetCurrentDefault();
+  fan_in->callbacks.clear();
+  for (int i = 0; i < kFanOut; ++i) {
+    fan_in->callbacks.push_back(base::BindOnce(
+        [](base::scoped_refptr<base::SequencedTaskRunner> task_runner,
+           base::WeakPtr<ReplyFanIn> fan_in, int value) {
+          task_runner->PostTask(
+              FROM_HERE, base::BindOnce(&ReplyFanIn::OnReply, fan_in, value));
+        },
+        task_runner, fan_in->AsWeakPtr()));
+  }
+  fan_in->worker->RunAndWait(&RunAllCallbacks, &fan_in->callbacks);
+}
+
+// The hand-written reply path that `MakeFuture` used to take: one task per
+// callback run on the worker.
+void BM_PostTaskPerReplyFanIn(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  WorkerThread worker;
+  ReplyFanIn fan_in(&worker);
+  for (auto _ : state) {
+    RunInTask(&PostReplies, fan_in);
+  }
+  CHECK(fan_in.sum == state.iterations() * kFanOut);
+  SetTasksPerFutureLabel(state);
+}
+FUTURES_BENCHMARK(BM_PostTaskPerReplyFanIn);
+
+void MakeFutures(ReplyFanIn* fan_in) {
+  fan_in->callbacks.clear();
+  for (int i = 0; i < kFanOut; ++i) {
+    base::MakeFuture<int>([fan_in](base::OnceCallback<void(int)> callback) {
+      fan_in->callbacks.push_back(std::move(callback));
+    }).AndThen([fan_in](int value) { fan_in->OnReply(value); });
+  }
+  fan_in->worker->RunAndWait(&RunAllCallbacks, &fan_in->callbacks);
+}
+
+// `MakeFuture` callbacks run on a worker are delivered in one task per batch.
+void BM_MakeFutureFanIn(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  WorkerThread worker;
+  ReplyFanIn fan_in(&worker);
+  for (auto _ : state) {
+    RunInTask(&MakeFutures, fan_in);
+  }
+  CHECK(fan_in.sum == state.iterations() * kFanOut);
+  SetTasksPerFutureLabel(state);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MakeFutureFanIn, 2 * kFanOut + 2, 2);
+
+}  // namespace
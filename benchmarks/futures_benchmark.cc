@@ -0,0 +1,777 @@
+// Microbenchmarks for the core Future/Promise operations, alongside the
+// callback-plus-`WeakPtr` patterns they are intended to replace.
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/check.h"
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/futures/coroutine_frame_allocator.h"
+#include "base/futures/future.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/threading/sequence_local_storage_slot.h"
+#include "base/types/expected.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+class Receiver {
+ public:
+  base::WeakPtr<Receiver> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  void OnValue(int value) { sum_ += value; }
+
+  int64_t sum() const { return sum_; }
+
+ private:
+  int64_t sum_ = 0;
+  base::WeakPtrFactory<Receiver> weak_factory_{this};
+};
+
+// The baseline: post a `WeakPtr`-bound member callback.
+void BM_PostWeakCallback(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&Receiver::OnValue, receiver.AsWeakPtr(), 1));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_PostWeakCallback, 1, 1);
+
+// Attach a continuation to a pending future, then resolve it.
+void BM_PromiseSetValueAndThen(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Promise<int> promise;
+    base::Future<int> future = promise.GetFuture();
+    std::move(future).AndThen(
+        base::BindOnce(&Receiver::OnValue, receiver.AsWeakPtr()));
+    promise.SetValue(1);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_PromiseSetValueAndThen, 2, 1);
+
+// Attach a continuation to a future that is already resolved.
+void BM_ReadyFutureAndThen(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::MakeReadyFuture(1).AndThen(
+        base::BindOnce(&Receiver::OnValue, receiver.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_ReadyFutureAndThen, 2, 1);
+
+// A chain of `Transform` steps, each running in its own turn.
+void BM_TransformChain(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  auto add_one = [](int value) { return value + 1; };
+  for (auto _ : state) {
+    base::MakeReadyFuture(0)
+        .Transform(base::BindOnce(add_one))
+        .Transform(base::BindOnce(add_one))
+        .Transform(base::BindOnce(add_one))
+        .AndThen(base::BindOnce(&Receiver::OnValue, receiver.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_TransformChain, 8, 1);
+
+void ResolveWithLambdaContinuation(Receiver* receiver) {
+  base::Promise<int> promise;
+  promise.GetFuture().AndThen(
+      [receiver = receiver->AsWeakPtr()](int value) {
+        if (receiver) {
+          receiver->OnValue(value);
+        }
+      });
+  promise.SetValue(1);
+}
+
+// As `BM_PromiseSetValueAndThen`, but with a lambda continuation, resolved
+// within a task. The lambda is stored inline in the promise and then in the
+// microtask queue, so the only allocation is the posted task.
+void BM_PromiseSetValueAndThenLambda(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&ResolveWithLambdaContinuation, &receiver));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_PromiseSetValueAndThenLambda, 1, 1);
+
+constexpr int kTransformSteps = 3;
+
+// As `BM_TransformChain`, but with lambdas. Each `Transform` step allocates
+// once, to hold the callable together with the promise for its result.
+void BM_TransformChainLambda(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  auto add_one = [](int value) { return value + 1; };
+  for (auto _ : state) {
+    base::MakeReadyFuture(0)
+        .Transform(add_one)
+        .Transform(add_one)
+        .Transform(add_one)
+        .AndThen([receiver = receiver.AsWeakPtr()](int value) {
+          if (receiver) {
+            receiver->OnValue(value);
+          }
+        });
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_TransformChainLambda, kTransformSteps + 1, 1);
+
+constexpr int kPromiseChainLength = 16;
+
+// A chain of promises, each resolved by the continuation of the previous one.
+// Continuations made runnable while a task runs are drained when it
+// completes, so the whole chain costs a single posted task.
+void BM_PromiseResolutionChain(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Promise<int> first;
+    base::Future<int> future = first.GetFuture();
+    for (int i = 1; i < kPromiseChainLength; ++i) {
+      base::Promise<int> next;
+      base::Future<int> next_future = next.GetFuture();
+      std::move(future).AndThen(base::BindOnce(
+          [](base::Promise<int> promise, int value) {
+            promise.SetValue(value + 1);
+          },
+          std::move(next)));
+      future = std::move(next_future);
+    }
+    std::move(future).AndThen(
+        base::BindOnce(&Receiver::OnValue, receiver.AsWeakPtr()));
+    first.SetValue(0);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_PromiseResolutionChain,
+                              kPromiseChainLength + 1,
+                              1);
+
+base::Future<int> AwaitReadyValue(Receiver& receiver) {
+  int value = co_await base::MakeReadyFuture(1);
+  receiver.OnValue(value);
+  co_return value;
+}
+
+// Start a coroutine that awaits a ready future. The coroutine continues
+// inline without posting.
+void BM_CoroutineAwaitReadyFuture(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Future<int> future = AwaitReadyValue(receiver);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineAwaitReadyFuture, 0, 0);
+
+// As above, but with every resumption posted.
+void BM_CoroutineAwaitReadyFutureAlwaysPost(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  base::internal::ScopedDisableInlineResumptionForTesting always_post;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Future<int> future = AwaitReadyValue(receiver);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineAwaitReadyFutureAlwaysPost, 1, 1);
+
+constexpr int kReadyAwaitsPerLoop = 16;
+
+base::Future<int> AwaitReadyValues(Receiver& receiver) {
+  int sum = 0;
+  for (int i = 0; i < kReadyAwaitsPerLoop; ++i) {
+    sum += co_await base::MakeReadyFuture(i);
+  }
+  receiver.OnValue(sum);
+  co_return sum;
+}
+
+// A coroutine that awaits many ready futures in a row, as on a cache-hit
+// path.
+void BM_CoroutineAwaitReadyFutureLoop(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Future<int> future = AwaitReadyValues(receiver);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineAwaitReadyFutureLoop, 0, 0);
+
+void BM_CoroutineAwaitReadyFutureLoopAlwaysPost(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  base::internal::ScopedDisableInlineResumptionForTesting always_post;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Future<int> future = AwaitReadyValues(receiver);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineAwaitReadyFutureLoopAlwaysPost, 1, 1);
+
+// Coroutines with zero, one and three weak-pointer arguments that resume
+// `kReadyAwaitsPerLoop` times each, to show the cost of the liveness check on
+// every resumption.
+base::Future<int> ResumeWithNoWeakArgs() {
+  int sum = 0;
+  for (int i = 0; i < kReadyAwaitsPerLoop; ++i) {
+    sum += co_await base::MakeReadyFuture(i);
+  }
+  co_return sum;
+}
+
+base::Future<int> ResumeWithOneWeakArg(Receiver& receiver) {
+  int sum = 0;
+  for (int i = 0; i < kReadyAwaitsPerLoop; ++i) {
+    sum += co_await base::MakeReadyFuture(i);
+  }
+  receiver.OnValue(sum);
+  co_return sum;
+}
+
+base::Future<int> ResumeWithThreeWeakArgs(Receiver& first,
+                                          Receiver& second,
+                                          Receiver& third) {
+  int sum = 0;
+  for (int i = 0; i < kReadyAwaitsPerLoop; ++i) {
+    sum += co_await base::MakeReadyFuture(i);
+  }
+  first.OnValue(sum);
+  second.OnValue(sum);
+  third.OnValue(sum);
+  co_return sum;
+}
+
+void BM_CoroutineResumeNoWeakArgs(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    base::Future<int> future = ResumeWithNoWeakArgs();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineResumeNoWeakArgs, 0, 0);
+
+void BM_CoroutineResumeOneWeakArg(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Future<int> future = ResumeWithOneWeakArg(receiver);
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineResumeOneWeakArg, 0, 0);
+
+void BM_CoroutineResumeThreeWeakArgs(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receivers[3];
+  for (auto _ : state) {
+    base::Future<int> future =
+        ResumeWithThreeWeakArgs(receivers[0], receivers[1], receivers[2]);
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineResumeThreeWeakArgs, 0, 0);
+
+constexpr int kSuspendedCoroutines = 16;
+
+base::Future<int> AwaitPendingValue(Receiver& receiver,
+                                    base::Future<int> future) {
+  int value = co_await std::move(future);
+  receiver.OnValue(value);
+  co_return value;
+}
+
+base::Future<void> AwaitPendingValues(Receiver& receiver,
+                                      base::Future<int> first,
+                                      base::Future<int> second) {
+  int values[] = {co_await std::move(first), co_await std::move(second)};
+  receiver.OnValue(values[0] + values[1]);
+}
+
+// Many coroutines with frames of two sizes suspended at once, then resumed.
+// Frames are recycled through the sequence's free lists, so only the
+// resumptions, posted because the promises are resolved outside of a task,
+// allocate.
+void BM_CoroutineFrameRecycling(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::Promise<int> promises[kSuspendedCoroutines];
+    for (int i = 0; i < kSuspendedCoroutines; i += 2) {
+      AwaitPendingValue(receiver, promises[i].GetFuture());
+      AwaitPendingValues(receiver, promises[i + 1].GetFuture(),
+                         base::MakeReadyFuture(i));
+    }
+    for (base::Promise<int>& promise : promises) {
+      promise.SetValue(1);
+    }
+    base::RunLoop().RunUntilIdle();
+  }
+  base::internal::CoroutineFrameAllocator::Stats stats =
+      base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence();
+  state.SetLabel(
+      "frame hit rate " +
+      std::to_string(stats.allocations
+                         ? 100 * stats.free_list_hits / stats.allocations
+                         : 0) +
+      "%, retained " + std::to_string(stats.retained_bytes) + " bytes");
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineFrameRecycling,
+                              kSuspendedCoroutines,
+                              kSuspendedCoroutines);
+
+void SuspendAndResumeCoroutines(Receiver* receiver) {
+  for (int i = 0; i < kSuspendedCoroutines; ++i) {
+    base::Promise<int> promise;
+    AwaitPendingValue(*receiver, promise.GetFuture());
+    promise.SetValue(i);
+  }
+}
+
+// Suspend/resume cycles of coroutines awaiting pending futures, resolved
+// within a task. The promise holds the suspended coroutine itself rather
+// than a callback, and frames are recycled, so the only allocation is the
+// posted task.
+void BM_CoroutineSuspendResume(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&SuspendAndResumeCoroutines, &receiver));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineSuspendResume, 1, 1);
+
+base::Future<int> AwaitReplyOf(base::Future<int> reply) {
+  int value = co_await std::move(reply);
+  co_return value;
+}
+
+// An object with a request in flight that may never be answered.
+class Session {
+ public:
+  base::WeakPtr<Session> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  base::Future<int> AwaitReply() {
+    int value = co_await reply_.GetFuture();
+    co_return value;
+  }
+
+ private:
+  base::Promise<int> reply_;
+  base::WeakPtrFactory<Session> weak_factory_{this};
+};
+
+// Sessions torn down while their coroutines are suspended. The frames are
+// destroyed along with the sessions, and recycled for the next ones, rather
+// than being kept alive by requests that will never complete.
+void BM_CoroutineOwnerTeardown(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    auto session = std::make_unique<Session>();
+    session->AwaitReply();
+    session.reset();
+  }
+  base::internal::CoroutineFrameAllocator::Stats stats =
+      base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence();
+  state.SetLabel("retained " + std::to_string(stats.retained_bytes) +
+                 " bytes");
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineOwnerTeardown, 2, 0);
+
+// A session that shuts down from within one of its own coroutines, as on a
+// protocol error, which then goes on to await a reply.
+class ClosingSession {
+ public:
+  base::WeakPtr<ClosingSession> AsWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  base::Future<int> CloseAndAwaitReply(base::Future<int> reply) {
+    weak_factory_.InvalidateWeakPtrs();
+    int value = co_await std::move(reply);
+    co_return value;
+  }
+
+ private:
+  base::WeakPtrFactory<ClosingSession> weak_factory_{this};
+};
+
+// Coroutines whose objects go away while they run, rather than while they
+// are suspended. They are destroyed at their next `co_await`, instead of
+// being left suspended on replies that are never sent.
+void BM_CoroutineOwnerTeardownWhileRunning(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  ClosingSession session;
+  base::Promise<int> pending_reply;
+  for (auto _ : state) {
+    const uint64_t live_frames = base::internal::CoroutineFrameAllocator::
+        GetStatsForCurrentSequence()
+            .live_frames;
+    base::Promise<int> reply;
+    session.CloseAndAwaitReply(reply.GetFuture());
+    CHECK(base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence()
+              .live_frames == live_frames);
+    // Kept pending, so that only destroying the frame releases it.
+    pending_reply = std::move(reply);
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineOwnerTeardownWhileRunning, 1, 0);
+
+base::Future<int> ForwardReply(base::Future<int> reply) {
+  int value = co_await AwaitReplyOf(std::move(reply));
+  co_return value;
+}
+
+// Requests whose responders are dropped without replying, as when a pipe
+// disconnects. Breaking the promise destroys the chain of coroutines
+// suspended on it, so their frames are recycled rather than leaked, and the
+// sequence ends with no live frames.
+void BM_CoroutineBrokenPromise(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    base::Promise<int> responder;
+    ForwardReply(responder.GetFuture());
+  }
+  base::internal::CoroutineFrameAllocator::Stats stats =
+      base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence();
+  state.SetLabel("live frames " + std::to_string(stats.live_frames));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineBrokenPromise, 0, 0);
+
+// Sequence-local state holding a request that is still pending when its
+// sequence shuts down.
+class PendingRequest {
+ public:
+  ~PendingRequest() {
+    // Breaks the promise, which destroys the coroutine suspended on it.
+    responder_ = base::Promise<int>();
+    base::internal::CoroutineFrameAllocator::Stats stats =
+        base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence();
+    CHECK(stats.allocations != 0);
+    CHECK(stats.live_frames == 0);
+  }
+
+  base::Future<int> GetReply() { return responder_.GetFuture(); }
+
+ private:
+  base::Promise<int> responder_;
+};
+
+// Sequences shutting down with a coroutine suspended on a sequence-local
+// promise. The state is created before the frame, so it is destroyed after
+// most sequence-local values; the allocator, which is destroyed last, still
+// counts the frame freed then.
+void BM_CoroutineFreedAtShutdown(benchmarks::State& state) {
+  for (auto _ : state) {
+    base::SingleThreadTaskExecutor executor;
+    static base::SequenceLocalStorageSlot<PendingRequest> slot;
+    AwaitReplyOf(slot.GetOrCreateValue().GetReply());
+  }
+}
+FUTURES_BENCHMARK(BM_CoroutineFreedAtShutdown);
+
+base::Future<int> AwaitReply(base::Future<int> reply) {
+  int value = co_await std::move(reply);
+  co_return value;
+}
+
+base::Future<int> AwaitReplyOrDefault(base::Future<int> reply) {
+  std::optional<int> value = co_await base::AwaitOptional(std::move(reply));
+  co_return value.value_or(-1);
+}
+
+// Replies whose responders were dropped before the request was awaited. A
+// plain `co_await` destroys the frame right away, and `AwaitOptional()`
+// continues with no value, rather than leaving the frame suspended on a
+// promise that can no longer resume it.
+void BM_CoroutineAwaitAlreadyBrokenPromise(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    const uint64_t live_frames = base::internal::CoroutineFrameAllocator::
+        GetStatsForCurrentSequence()
+            .live_frames;
+    base::Future<int> reply;
+    {
+      base::Promise<int> responder;
+      reply = responder.GetFuture();
+    }
+    AwaitReply(std::move(reply));
+    CHECK(base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence()
+              .live_frames == live_frames);
+
+    base::Future<int> optional_reply;
+    {
+      base::Promise<int> responder;
+      optional_reply = responder.GetFuture();
+    }
+    base::Future<int> result = AwaitReplyOrDefault(std::move(optional_reply));
+    CHECK(base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence()
+              .live_frames == live_frames);
+    CHECK(result.is_ready() && std::move(result).GetValueSynchronously() == -1);
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineAwaitAlreadyBrokenPromise, 0, 0);
+
+// Errors returned through a stack of coroutines, as when a backend lookup
+// fails under several layers of callers. The message is long enough that
+// copying it would allocate.
+using LookupResult = base::expected<int, std::string>;
+
+constexpr int kErrorPropagationDepth = 4;
+
+base::Future<LookupResult> FailingLookup() {
+  co_return base::unexpected(
+      std::string("backend unavailable: deadline exceeded"));
+}
+
+base::Future<LookupResult> LookupCheckingErrors(int depth) {
+  base::Future<LookupResult> lookup =
+      depth == 0 ? FailingLookup() : LookupCheckingErrors(depth - 1);
+  LookupResult result = co_await std::move(lookup);
+  if (!result.has_value()) {
+    co_return base::unexpected(std::move(result).error());
+  }
+  co_return *result + 1;
+}
+
+base::Future<LookupResult> LookupReturningErrors(int depth) {
+  base::Future<LookupResult> lookup =
+      depth == 0 ? FailingLookup() : LookupReturningErrors(depth - 1);
+  int value = co_await base::AwaitOrReturnError(std::move(lookup));
+  co_return value + 1;
+}
+
+// The error is checked and rewrapped by hand at each level, which moves it
+// through a local `expected` and an `unexpected`.
+void BM_CoroutineErrorCheckedByHand(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    base::Future<LookupResult> future =
+        LookupCheckingErrors(kErrorPropagationDepth);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineErrorCheckedByHand, 1, 0);
+
+// `AwaitOrReturnError()` moves the error straight into each caller's result,
+// and destroys each frame without resuming it.
+void BM_CoroutineAwaitOrReturnError(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  for (auto _ : state) {
+    base::Future<LookupResult> future =
+        LookupReturningErrors(kErrorPropagationDepth);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_CoroutineAwaitOrReturnError, 1, 0);
+
+// A configuration blob awaited by many components. The blob is large enough
+// that each copy allocates.
+constexpr int kManifestConsumers = 32;
+constexpr size_t kManifestSize = 4096;
+
+base::Future<void> ConfigureFromCopy(Receiver& receiver,
+                                     base::Future<std::string> manifest) {
+  std::string value = co_await std::move(manifest);
+  receiver.OnValue(static_cast<int>(value.size()));
+}
+
+base::Future<void> ConfigureFromShared(
+    Receiver& receiver,
+    base::SharedFuture<std::string> manifest) {
+  const std::string& value = co_await manifest;
+  receiver.OnValue(static_cast<int>(value.size()));
+}
+
+void FanOutManifestCopies(Receiver* receiver) {
+  std::vector<base::Promise<std::string>> promises(kManifestConsumers);
+  for (base::Promise<std::string>& promise : promises) {
+    ConfigureFromCopy(*receiver, promise.GetFuture());
+  }
+  const std::string manifest(kManifestSize, 'm');
+  for (base::Promise<std::string>& promise : promises) {
+    promise.SetValue(manifest);
+  }
+}
+
+// Each consumer awaits a future of its own, so the producer hands out a copy
+// of the manifest per consumer.
+void BM_ManifestFanOutCopies(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&FanOutManifestCopies, &receiver));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_ManifestFanOutCopies,
+                              kManifestConsumers + 3,
+                              1);
+
+void FanOutSharedManifest(Receiver* receiver) {
+  base::Promise<std::string> promise;
+  base::SharedFuture<std::string> manifest = promise.GetFuture().Share();
+  for (int i = 0; i < kManifestConsumers; ++i) {
+    ConfigureFromShared(*receiver, manifest);
+  }
+  promise.SetValue(std::string(kManifestSize, 'm'));
+}
+
+// All consumers await one `SharedFuture`, which stores the manifest once.
+// Suspended coroutines are linked into the shared state, so besides the task
+// and the manifest, the state is the only allocation.
+void BM_ManifestFanOutShared(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+        FROM_HERE, base::BindOnce(&FanOutSharedManifest, &receiver));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_ManifestFanOutShared, 3, 1);
+
+// A component that shuts down from within the coroutine that configures it,
+// before the manifest arrives.
+class ClosingComponent {
+ public:
+  base::WeakPtr<ClosingComponent> AsWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  base::Future<void> CloseAndConfigure(
+      base::SharedFuture<std::string> manifest) {
+    weak_factory_.InvalidateWeakPtrs();
+    const std::string& value = co_await manifest;
+    manifest_size_ = value.size();
+  }
+
+ private:
+  size_t manifest_size_ = 0;
+  base::WeakPtrFactory<ClosingComponent> weak_factory_{this};
+};
+
+// As `BM_CoroutineOwnerTeardownWhileRunning`, for a `SharedFuture`: the
+// coroutine is destroyed rather than linked into the pending shared state.
+void BM_ManifestConsumerTeardownWhileRunning(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  ClosingComponent component;
+  base::Promise<std::string> promise;
+  base::SharedFuture<std::string> manifest = promise.GetFuture().Share();
+  for (auto _ : state) {
+    const uint64_t live_frames = base::internal::CoroutineFrameAllocator::
+        GetStatsForCurrentSequence()
+            .live_frames;
+    component.CloseAndConfigure(manifest);
+    CHECK(base::internal::CoroutineFrameAllocator::GetStatsForCurrentSequence()
+              .live_frames == live_frames);
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_ManifestConsumerTeardownWhileRunning, 1, 0);
+
+// Resolve a `MakeFuture` callback on the future's own sequence.
+void BM_MakeFutureSameSequence(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  for (auto _ : state) {
+    base::MakeFuture<int>([](base::OnceCallback<void(int)> callback) {
+      std::move(callback).Run(1);
+    }).AndThen(base::BindOnce(&Receiver::OnValue, receiver.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MakeFutureSameSequence, 4, 1);
+
+constexpr int kPrefetches = 100;
+constexpr int kPrefetchesUsed = 10;
+
+// Stands in for the work of producing a prefetched value.
+int ComputePrefetchedValue(int seed) {
+  uint32_t value = static_cast<uint32_t>(seed);
+  for (int i = 0; i < 256; ++i) {
+    value = value * 1103515245u + 12345u;
+  }
+  return static_cast<int>(value >> 16);
+}
+
+// Speculatively prefetches `kPrefetches` values, of which the consumer keeps
+// only `kPrefetchesUsed`. Returns the number of values computed.
+int Prefetch(Receiver& receiver, bool skip_abandoned) {
+  base::Promise<int> promises[kPrefetches];
+  base::Future<int> kept[kPrefetchesUsed];
+  for (int i = 0; i < kPrefetches; ++i) {
+    base::Future<int> future = promises[i].GetFuture();
+    if (i % (kPrefetches / kPrefetchesUsed) == 0) {
+      kept[i / (kPrefetches / kPrefetchesUsed)] = std::move(future);
+    }
+  }
+  int computed = 0;
+  for (int i = 0; i < kPrefetches; ++i) {
+    if (skip_abandoned && promises[i].IsAbandoned()) {
+      continue;
+    }
+    promises[i].SetValue(ComputePrefetchedValue(i));
+    ++computed;
+  }
+  for (base::Future<int>& future : kept) {
+    receiver.OnValue(std::move(future).GetValueSynchronously());
+  }
+  return computed;
+}
+
+// Producers that check `IsAbandoned()` skip the values whose futures the
+// consumer has already dropped.
+void BM_SpeculativePrefetch(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  int computed = 0;
+  for (auto _ : state) {
+    computed = Prefetch(receiver, /*skip_abandoned=*/true);
+  }
+  state.SetLabel("computed " + std::to_string(computed) + "/" +
+                 std::to_string(kPrefetches));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_SpeculativePrefetch, 0, 0);
+
+void BM_SpeculativePrefetchUnchecked(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Receiver receiver;
+  int computed = 0;
+  for (auto _ : state) {
+    computed = Prefetch(receiver, /*skip_abandoned=*/false);
+  }
+  state.SetLabel("computed " + std::to_string(computed) + "/" +
+                 std::to_string(kPrefetches));
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_SpeculativePrefetchUnchecked, 0, 0);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  return benchmarks::RunRegisteredBenchmarks(argc, argv);
+}
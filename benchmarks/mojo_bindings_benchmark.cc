@@ -0,0 +1,244 @@
+// Benchmarks for future-returning mojo interface methods, per round-trip over
+// an in-process message pipe, against the callback form they extend.
+//
+// The pipe and client endpoint are the stand-ins in mojo/public/cpp/bindings.
+// `TableProxy` is what the bindings generator would emit for the README's
+// `db.mojom.Table` interface, extended with a method with a large response:
+//
+//   interface Table {
+//     GetCount() => (uint64 count);
+//     ReadAll() => (string data);
+//   };
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/check.h"
+#include "base/functional/callback.h"
+#include "base/futures/future.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "benchmarks/benchmark_runner.h"
+#include "mojo/public/cpp/bindings/interface_endpoint_client.h"
+#include "mojo/public/cpp/bindings/message.h"
+#include "mojo/public/cpp/bindings/promise_responder.h"
+
+namespace {
+
+using mojo::Message;
+
+constexpr size_t kReadAllSize = 64 * 1024;
+
+// The service end, with the implementation of `db.mojom.Table`.
+class TableImpl : public mojo::MessageReceiver {
+ public:
+  static constexpr uint32_t kGetCountName = 1;
+  static constexpr uint32_t kReadAllName = 2;
+
+  void set_client(base::WeakPtr<mojo::MessageReceiver> client) {
+    client_ = std::move(client);
+  }
+
+  base::WeakPtr<TableImpl> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  // Dispatches a request read from the pipe, and writes the response.
+  void Accept(const Message& request) override {
+    Message response = request;
+    if (request.name == kGetCountName) {
+      response.payload = ++count_;
+    } else {
+      response.body.assign(kReadAllSize, 'x');
+    }
+    mojo::WriteMessage(client_, std::move(response));
+  }
+
+ private:
+  base::WeakPtr<mojo::MessageReceiver> client_;
+  uint64_t count_ = 0;
+  base::WeakPtrFactory<TableImpl> weak_factory_{this};
+};
+
+// The generated proxy for `db.mojom.Table`.
+class TableProxy {
+ public:
+  using GetCountCallback = base::OnceCallback<void(uint64_t)>;
+
+  explicit TableProxy(mojo::InterfaceEndpointClient* client)
+      : client_(client) {}
+
+  // The callback form, whose responder forwards the deserialized response to
+  // the callback.
+  void GetCount(GetCountCallback callback) {
+    client_->SendWithResponder(
+        Message(TableImpl::kGetCountName),
+        std::make_unique<GetCountForwardToCallback>(std::move(callback)));
+  }
+
+  // The future form as first proposed: the callback form wrapped in
+  // `MakeFuture`, which adds a cross-sequence promise and a bound callback.
+  base::Future<uint64_t> GetCountWithMakeFuture() {
+    return base::MakeFuture<uint64_t>(
+        [this](auto callback) { GetCount(std::move(callback)); });
+  }
+
+  // The generated future forms. The responder holds the promise, and
+  // resolves it as it deserializes the response.
+  base::Future<uint64_t> GetCount() {
+    return mojo::SendWithPromiseResponder<GetCountForwardToPromise>(
+        *client_, Message(TableImpl::kGetCountName));
+  }
+
+  base::Future<std::string> ReadAll() {
+    return mojo::SendWithPromiseResponder<ReadAllForwardToPromise>(
+        *client_, Message(TableImpl::kReadAllName));
+  }
+
+ private:
+  class GetCountForwardToCallback : public mojo::MessageReceiver {
+   public:
+    explicit GetCountForwardToCallback(GetCountCallback callback)
+        : callback_(std::move(callback)) {}
+
+    void Accept(const Message& response) override {
+      uint64_t count = response.payload;
+      std::move(callback_).Run(count);
+    }
+
+   private:
+    GetCountCallback callback_;
+  };
+
+  class GetCountForwardToPromise : public mojo::PromiseResponder<uint64_t> {
+   public:
+    using PromiseResponder::PromiseResponder;
+
+   private:
+    uint64_t Deserialize(const Message& response) override {
+      return response.payload;
+    }
+  };
+
+  class ReadAllForwardToPromise
+      : public mojo::PromiseResponder<std::string> {
+   public:
+    using PromiseResponder::PromiseResponder;
+
+   private:
+    std::string Deserialize(const Message& response) override {
+      return std::string(response.body);
+    }
+  };
+
+  mojo::InterfaceEndpointClient* client_;
+};
+
+class Receiver {
+ public:
+  base::WeakPtr<Receiver> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  void OnCount(uint64_t count) { sum_ += count; }
+  void OnData(const std::string& data) { sum_ += data.size(); }
+
+ private:
+  uint64_t sum_ = 0;
+  base::WeakPtrFactory<Receiver> weak_factory_{this};
+};
+
+// A remote bound to an in-process implementation.
+struct Connection {
+  Connection() { service.set_client(client.AsWeakPtr()); }
+
+  TableImpl service;
+  mojo::InterfaceEndpointClient client{service.AsWeakPtr()};
+  TableProxy proxy{&client};
+};
+
+// The baseline: a callback bound to a weak receiver. Besides the two tasks
+// that carry the messages, the responder, its map node and the bound
+// callback allocate.
+void BM_MojoRoundTripCallback(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  Receiver receiver;
+  for (auto _ : state) {
+    connection.proxy.GetCount(
+        base::BindOnce(&Receiver::OnCount, receiver.AsWeakPtr()));
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MojoRoundTripCallback, 5, 2);
+
+// The `MakeFuture` wrapper adds the cross-sequence promise's state, and
+// its callback's bound state, to the callback form.
+void BM_MojoRoundTripMakeFuture(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  Receiver receiver;
+  for (auto _ : state) {
+    connection.proxy.GetCountWithMakeFuture().AndThen(
+        [receiver = receiver.AsWeakPtr()](uint64_t count) {
+          if (receiver) {
+            receiver->OnCount(count);
+          }
+        });
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MojoRoundTripMakeFuture, 6, 2);
+
+// The generated future form. The promise lives in the responder, and the
+// continuation is stored inline in the promise, so nothing is allocated
+// besides the messages' tasks and the responder with its map node.
+void BM_MojoRoundTripFuture(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  Receiver receiver;
+  for (auto _ : state) {
+    connection.proxy.GetCount().AndThen(
+        [receiver = receiver.AsWeakPtr()](uint64_t count) {
+          if (receiver) {
+            receiver->OnCount(count);
+          }
+        });
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MojoRoundTripFuture, 4, 2);
+
+// A large response whose future is consumed: deserializing it copies the
+// body.
+void BM_MojoReadAllConsumed(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  Receiver receiver;
+  for (auto _ : state) {
+    connection.proxy.ReadAll().AndThen(
+        [receiver = receiver.AsWeakPtr()](std::string data) {
+          if (receiver) {
+            receiver->OnData(data);
+          }
+        });
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MojoReadAllConsumed, 6, 2);
+
+// The same response to a request whose future is dropped: the responder is
+// unregistered with the future, and the response is discarded by the client
+// endpoint before it is deserialized. Only the service's work remains.
+void BM_MojoReadAllDropped(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  for (auto _ : state) {
+    connection.proxy.ReadAll();
+    CHECK(connection.client.num_pending_responses() == 0);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_MojoReadAllDropped, 5, 2);
+
+}  // namespace
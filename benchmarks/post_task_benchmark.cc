@@ -0,0 +1,175 @@
+// Benchmarks for posting a task and receiving its result as a future, both to
+// a worker sequence and to the current one, against `MakeFuture` wrapped
+// around a task-and-reply. The tasks are trivial, so that the cost measured
+// is that of the hops.
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/futures/future.h"
+#include "base/futures/post_task.h"
+#include "base/location.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+// A thread running tasks posted to its own sequence, as a thread-pool
+// sequence would.
+class WorkerSequence {
+ public:
+  WorkerSequence() : thread_([this] { Run(); }) {
+    std::unique_lock<std::mutex> lock(lock_);
+    started_.wait(lock, [this] { return !!task_runner_; });
+  }
+  WorkerSequence(const WorkerSequence&) = delete;
+  WorkerSequence& operator=(const WorkerSequence&) = delete;
+
+  ~WorkerSequence() {
+    std::move(quit_).Run();
+    thread_.join();
+  }
+
+  const base::scoped_refptr<base::SequencedTaskRunner>& task_runner() const {
+    return task_runner_;
+  }
+
+ private:
+  void Run() {
+    base::SingleThreadTaskExecutor executor;
+    base::RunLoop run_loop;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      task_runner_ = executor.task_runner();
+      quit_ = run_loop.QuitClosure();
+    }
+    started_.notify_one();
+    run_loop.Run();
+  }
+
+  std::mutex lock_;
+  std::condition_variable started_;
+  base::scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  base::OnceClosure quit_;
+  std::thread thread_;
+};
+
+// A task and a reply with its result, as Chromium's
+// `PostTaskAndReplyWithResult`: the reply is posted back to the current
+// sequence once the task has run.
+template <typename R>
+void PostTaskAndReplyWithResult(
+    const base::scoped_refptr<base::SequencedTaskRunner>& task_runner,
+    const base::Location& from_here,
+    base::OnceCallback<R()> task,
+    base::OnceCallback<void(R)> reply) {
+  task_runner->PostTask(
+      from_here,
+      base::BindOnce(
+          [](base::OnceCallback<R()> task, base::OnceCallback<void(R)> reply,
+             base::scoped_refptr<base::SequencedTaskRunner> reply_runner) {
+            reply_runner->PostTask(
+                FROM_HERE,
+                base::BindOnce(
+                    [](base::OnceCallback<void(R)> reply, R result) {
+                      std::move(reply).Run(std::move(result));
+                    },
+                    std::move(reply), std::move(task).Run()));
+          },
+          std::move(task), std::move(reply),
+          base::SequencedTaskRunner::GetCurrentDefault()));
+}
+
+int Square(int value) {
+  return value * value;
+}
+
+// The layering that `PostTaskWithResult` replaces: the future's callback is
+// run by the reply task, and resolves a cross-sequence promise, which in turn
+// schedules the continuation rather than running it.
+base::Future<int> SquareWithMakeFuture(
+    const base::scoped_refptr<base::SequencedTaskRunner>& task_runner,
+    int value) {
+  return base::MakeFuture<int>([&](auto callback) {
+    PostTaskAndReplyWithResult(task_runner, FROM_HERE,
+                               base::BindOnce(&Square, value),
+                               std::move(callback));
+  });
+}
+
+base::Future<int> SquareWithPostTaskWithResult(
+    const base::scoped_refptr<base::SequencedTaskRunner>& task_runner,
+    int value) {
+  return base::PostTaskWithResult(task_runner, FROM_HERE,
+                                  [value] { return Square(value); });
+}
+
+// Offloads each iteration's task to a worker sequence, and waits for its
+// result. Only the tasks posted back to the current sequence are counted.
+template <base::Future<int> (*SquareOn)(
+    const base::scoped_refptr<base::SequencedTaskRunner>&,
+    int)>
+void RunOnWorker(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  WorkerSequence worker;
+  int64_t sum = 0;
+  int value = 0;
+  for (auto _ : state) {
+    base::RunLoop run_loop;
+    SquareOn(worker.task_runner(), ++value % 1024)
+        .AndThen([&sum, &run_loop](int result) {
+          sum += result;
+          run_loop.Quit();
+        });
+    run_loop.Run();
+  }
+}
+
+template <base::Future<int> (*SquareOn)(
+    const base::scoped_refptr<base::SequencedTaskRunner>&,
+    int)>
+void RunOnCurrentSequence(benchmarks::State& state) {
+  base::SingleThreadTaskExecutor executor;
+  int64_t sum = 0;
+  int value = 0;
+  for (auto _ : state) {
+    SquareOn(executor.task_runner(), ++value % 1024)
+        .AndThen([&sum](int result) { sum += result; });
+    base::RunLoop().RunUntilIdle();
+  }
+}
+
+// A reply task, which schedules the continuation. Besides the tasks' bound
+// state, the cross-sequence promise's state and its callback allocate.
+void BM_OffloadMakeFuture(benchmarks::State& state) {
+  RunOnWorker<&SquareWithMakeFuture>(state);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_OffloadMakeFuture, 5, 1);
+
+// The worker resolves a cross-sequence promise, and the task that delivers it
+// runs the continuation.
+void BM_OffloadPostTaskWithResult(benchmarks::State& state) {
+  RunOnWorker<&SquareWithPostTaskWithResult>(state);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_OffloadPostTaskWithResult, 3, 1);
+
+void BM_SameSequenceMakeFuture(benchmarks::State& state) {
+  RunOnCurrentSequence<&SquareWithMakeFuture>(state);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_SameSequenceMakeFuture, 5, 2);
+
+// The task resolves the future, and runs the continuation, itself.
+void BM_SameSequencePostTaskWithResult(benchmarks::State& state) {
+  RunOnCurrentSequence<&SquareWithPostTaskWithResult>(state);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_SameSequencePostTaskWithResult, 1, 1);
+
+}  // namespace
@@ -0,0 +1,117 @@
+// Benchmarks for keeping many timeouts pending, as a server does with one per
+// in-flight request. Each iteration cancels one pending timer, as when its
+// request completes, and starts another, with the timer wheel and with the
+// task queue's delayed heap at 10^3 to 10^6 pending timers.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/functional/bind.h"
+#include "base/location.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/delayed_task_handle.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/task/timer_wheel.h"
+#include "benchmarks/benchmark_runner.h"
+
+namespace {
+
+// Timeouts are spread over a minute, starting far enough out that none comes
+// due during a run.
+base::TimeDelta GetTimeout(uint32_t& seed) {
+  seed = seed * 1664525 + 1013904223;
+  return base::Seconds(60) + base::Milliseconds(seed % 60000);
+}
+
+class TimeoutTimer final : public base::TimerWheel::Timer {
+ private:
+  void OnTimerFired() override {}
+};
+
+void RunTimerWheelChurn(benchmarks::State& state, size_t num_timers) {
+  base::SingleThreadTaskExecutor executor;
+  base::TimerWheel& wheel = base::TimerWheel::GetForCurrentSequence();
+  std::vector<TimeoutTimer> timers(num_timers);
+  uint32_t seed = 1;
+  for (TimeoutTimer& timer : timers) {
+    wheel.Schedule(timer, GetTimeout(seed));
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    TimeoutTimer& timer = timers[next];
+    timer.Cancel();
+    wheel.Schedule(timer, GetTimeout(seed));
+    next = next + 1 == num_timers ? 0 : next + 1;
+  }
+  state.SetLabel("pending timers " + std::to_string(wheel.GetNumTimers()));
+}
+
+void RunDelayedTaskChurn(benchmarks::State& state, size_t num_timers) {
+  base::SingleThreadTaskExecutor executor;
+  const base::scoped_refptr<base::SequencedTaskRunner>& task_runner =
+      base::SequencedTaskRunner::GetCurrentDefault();
+  std::vector<base::DelayedTaskHandle> handles(num_timers);
+  uint32_t seed = 1;
+  for (base::DelayedTaskHandle& handle : handles) {
+    handle = task_runner->PostCancelableDelayedTask(
+        FROM_HERE, base::BindOnce([] {}), GetTimeout(seed));
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    base::DelayedTaskHandle& handle = handles[next];
+    handle.CancelTask();
+    handle = task_runner->PostCancelableDelayedTask(
+        FROM_HERE, base::BindOnce([] {}), GetTimeout(seed));
+    next = next + 1 == num_timers ? 0 : next + 1;
+  }
+  state.SetLabel("pending timers " + std::to_string(handles.size()));
+}
+
+// Timers are linked into the wheel's slots, so neither cancelling nor
+// scheduling one allocates or posts.
+void BM_TimerWheelChurn1K(benchmarks::State& state) {
+  RunTimerWheelChurn(state, 1000);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_TimerWheelChurn1K, 0, 0);
+
+void BM_TimerWheelChurn10K(benchmarks::State& state) {
+  RunTimerWheelChurn(state, 10000);
+}
+FUTURES_BENCHMARK(BM_TimerWheelChurn10K);
+
+void BM_TimerWheelChurn100K(benchmarks::State& state) {
+  RunTimerWheelChurn(state, 100000);
+}
+FUTURES_BENCHMARK(BM_TimerWheelChurn100K);
+
+void BM_TimerWheelChurn1M(benchmarks::State& state) {
+  RunTimerWheelChurn(state, 1000000);
+}
+FUTURES_BENCHMARK(BM_TimerWheelChurn1M);
+
+// Each timeout is a task of its own, whose closure is allocated, and whose
+// heap entry costs logarithmic time to insert and remove.
+void BM_DelayedTaskChurn1K(benchmarks::State& state) {
+  RunDelayedTaskChurn(state, 1000);
+}
+FUTURES_BENCHMARK_WITH_BUDGET(BM_DelayedTaskChurn1K, 1, 1);
+
+void BM_DelayedTaskChurn10K(benchmarks::State& state) {
+  RunDelayedTaskChurn(state, 10000);
+}
+FUTURES_BENCHMARK(BM_DelayedTaskChurn10K);
+
+void BM_DelayedTaskChurn100K(benchmarks::State& state) {
+  RunDelayedTaskChurn(state, 100000);
+}
+FUTURES_BENCHMARK(BM_DelayedTaskChurn100K);
+
+void BM_DelayedTaskChurn1M(benchmarks::State& state) {
+  RunDelayedTaskChurn(state, 1000000);
+}
+FUTURES_BENCHMARK(BM_DelayedTaskChurn1M);
+
+}  // namespace
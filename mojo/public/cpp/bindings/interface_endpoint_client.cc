@@ -0,0 +1,38 @@
+#include "mojo/public/cpp/bindings/interface_endpoint_client.h"
+
+#include <utility>
+
+namespace mojo {
+
+InterfaceEndpointClient::InterfaceEndpointClient(
+    base::WeakPtr<MessageReceiver> service)
+    : service_(std::move(service)) {}
+
+InterfaceEndpointClient::~InterfaceEndpointClient() = default;
+
+uint64_t InterfaceEndpointClient::SendWithResponder(
+    Message request,
+    std::unique_ptr<MessageReceiver> responder) {
+  const uint64_t request_id = next_request_id_++;
+  request.request_id = request_id;
+  responders_.emplace(request_id, std::move(responder));
+  WriteMessage(service_, std::move(request));
+  return request_id;
+}
+
+void InterfaceEndpointClient::RemoveResponder(uint64_t request_id) {
+  responders_.erase(request_id);
+}
+
+void InterfaceEndpointClient::Accept(const Message& response) {
+  auto it = responders_.find(response.request_id);
+  if (it == responders_.end()) {
+    // The request was cancelled: the response is discarded unread.
+    return;
+  }
+  std::unique_ptr<MessageReceiver> responder = std::move(it->second);
+  responders_.erase(it);
+  responder->Accept(response);
+}
+
+}  // namespace mojo
@@ -0,0 +1,52 @@
+#ifndef MOJO_PUBLIC_CPP_BINDINGS_INTERFACE_ENDPOINT_CLIENT_H_
+#define MOJO_PUBLIC_CPP_BINDINGS_INTERFACE_ENDPOINT_CLIENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+#include "base/memory/weak_ptr.h"
+#include "mojo/public/cpp/bindings/message.h"
+
+namespace mojo {
+
+// The client end of an interface pipe, like mojo's `InterfaceEndpointClient`.
+// Requests are written to the service's receiver, and the responses read
+// back are routed to the responders registered for their requests. Must be
+// used on a single sequence.
+class InterfaceEndpointClient : public MessageReceiver {
+ public:
+  explicit InterfaceEndpointClient(base::WeakPtr<MessageReceiver> service);
+  InterfaceEndpointClient(const InterfaceEndpointClient&) = delete;
+  InterfaceEndpointClient& operator=(const InterfaceEndpointClient&) = delete;
+  ~InterfaceEndpointClient() override;
+
+  // Sends `request`, and registers `responder` to accept its response.
+  // Returns the id of the request.
+  uint64_t SendWithResponder(Message request,
+                             std::unique_ptr<MessageReceiver> responder);
+
+  // Destroys the responder of a request whose response is no longer wanted.
+  // The response is then discarded unread when it arrives.
+  void RemoveResponder(uint64_t request_id);
+
+  size_t num_pending_responses() const { return responders_.size(); }
+
+  base::WeakPtr<InterfaceEndpointClient> AsWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  // MessageReceiver, for responses:
+  void Accept(const Message& response) override;
+
+ private:
+  const base::WeakPtr<MessageReceiver> service_;
+  uint64_t next_request_id_ = 1;
+  std::map<uint64_t, std::unique_ptr<MessageReceiver>> responders_;
+  base::WeakPtrFactory<InterfaceEndpointClient> weak_factory_{this};
+};
+
+}  // namespace mojo
+
+#endif  // MOJO_PUBLIC_CPP_BINDINGS_INTERFACE_ENDPOINT_CLIENT_H_
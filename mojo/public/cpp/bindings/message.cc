@@ -0,0 +1,17 @@
+#include "mojo/public/cpp/bindings/message.h"
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/location.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace mojo {
+
+void WriteMessage(base::WeakPtr<MessageReceiver> receiver, Message message) {
+  base::SequencedTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(&MessageReceiver::Accept, std::move(receiver),
+                                std::move(message)));
+}
+
+}  // namespace mojo
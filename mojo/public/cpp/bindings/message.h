@@ -0,0 +1,38 @@
+#ifndef MOJO_PUBLIC_CPP_BINDINGS_MESSAGE_H_
+#define MOJO_PUBLIC_CPP_BINDINGS_MESSAGE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "base/memory/weak_ptr.h"
+
+namespace mojo {
+
+// A minimal stand-in for a serialized mojo message: the method's name and
+// the request's id, and the method's single argument or response field,
+// which is either a number or a string.
+struct Message {
+  explicit Message(uint32_t name) : name(name) {}
+
+  uint32_t name;
+  uint64_t request_id = 0;
+  uint64_t payload = 0;
+  std::string body;
+};
+
+// Receives messages read from a pipe, like mojo's `MessageReceiver`.
+class MessageReceiver {
+ public:
+  virtual ~MessageReceiver() = default;
+
+  virtual void Accept(const Message& message) = 0;
+};
+
+// Writes `message` to the pipe read by `receiver`. The message crosses the
+// pipe in a task posted to the current sequence, as if the other end had
+// become readable, and is dropped if `receiver` is gone by then.
+void WriteMessage(base::WeakPtr<MessageReceiver> receiver, Message message);
+
+}  // namespace mojo
+
+#endif  // MOJO_PUBLIC_CPP_BINDINGS_MESSAGE_H_
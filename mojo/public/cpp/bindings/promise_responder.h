@@ -0,0 +1,89 @@
+#ifndef MOJO_PUBLIC_CPP_BINDINGS_PROMISE_RESPONDER_H_
+#define MOJO_PUBLIC_CPP_BINDINGS_PROMISE_RESPONDER_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "base/futures/future.h"
+#include "base/futures/promise_observer.h"
+#include "mojo/public/cpp/bindings/interface_endpoint_client.h"
+#include "mojo/public/cpp/bindings/message.h"
+
+namespace mojo {
+
+// The base of the responders of generated future-returning methods, which
+// hold the promise for the response and resolve it as they deserialize it.
+// Responses are dispatched in a task of their own, on the remote's sequence,
+// so the continuation or awaiting coroutine runs right away rather than in a
+// further turn.
+//
+// If the future is destroyed or abandoned before the response arrives,
+// including along with a coroutine awaiting it, the responder unregisters
+// itself, and the client discards the response without deserializing it.
+//
+//   class Table_GetCount_ForwardToPromise : public PromiseResponder<uint64_t> {
+//    public:
+//     using PromiseResponder::PromiseResponder;
+//
+//    private:
+//     uint64_t Deserialize(const Message& response) override { ... }
+//   };
+//
+//   base::Future<uint64_t> TableProxy::GetCount() {
+//     return SendWithPromiseResponder<Table_GetCount_ForwardToPromise>(
+//         *client_, Message(kTable_GetCount_Name));
+//   }
+template <typename T>
+class PromiseResponder : public MessageReceiver,
+                         public base::PromiseAbandonmentObserver {
+ public:
+  using ValueType = T;
+
+  PromiseResponder(InterfaceEndpointClient* client, base::Promise<T> promise)
+      : client_(client), promise_(std::move(promise)) {
+    promise_.OnAbandoned(this);
+  }
+
+  void set_request_id(uint64_t request_id) { request_id_ = request_id; }
+
+  // MessageReceiver:
+  void Accept(const Message& response) final {
+    promise_.SetValueWithSideEffects(Deserialize(response));
+  }
+
+ protected:
+  virtual T Deserialize(const Message& response) = 0;
+
+ private:
+  // base::PromiseAbandonmentObserver:
+  void OnPromiseAbandoned() final {
+    // Destroys this responder, and the promise with it.
+    client_->RemoveResponder(request_id_);
+  }
+
+  // The client owns its responders.
+  InterfaceEndpointClient* const client_;
+  uint64_t request_id_ = 0;
+  base::Promise<T> promise_;
+};
+
+// Sends `request` through `client`, with a `ResponderType` derived from
+// `PromiseResponder`, and returns the future for its response.
+template <typename ResponderType>
+base::Future<typename ResponderType::ValueType> SendWithPromiseResponder(
+    InterfaceEndpointClient& client,
+    Message request) {
+  using T = typename ResponderType::ValueType;
+  base::Promise<T> promise;
+  base::Future<T> future = promise.GetFuture();
+  auto responder = std::make_unique<ResponderType>(&client, std::move(promise));
+  ResponderType* raw_responder = responder.get();
+  raw_responder->set_request_id(
+      client.SendWithResponder(std::move(request), std::move(responder)));
+  return future;
+}
+
+}  // namespace mojo
+
+#endif  // MOJO_PUBLIC_CPP_BINDINGS_PROMISE_RESPONDER_H_
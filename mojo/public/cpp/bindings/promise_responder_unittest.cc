@@ -0,0 +1,162 @@
+// Checks that a `PromiseResponder` resolves its future with the response, and
+// that dropping or abandoning the future cancels the request: the responder is
+// unregistered at once, and the response is discarded unread.
+//
+// The tree has no test framework, so each case CHECKs its expectations, and
+// the binary exits with success once they all hold.
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "base/check.h"
+#include "base/futures/future.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "mojo/public/cpp/bindings/interface_endpoint_client.h"
+#include "mojo/public/cpp/bindings/message.h"
+#include "mojo/public/cpp/bindings/promise_responder.h"
+
+namespace mojo {
+namespace {
+
+constexpr uint32_t kIncrementName = 1;
+
+// Replies to each request with its payload, incremented.
+class IncrementService : public MessageReceiver {
+ public:
+  void set_client(base::WeakPtr<MessageReceiver> client) {
+    client_ = std::move(client);
+  }
+
+  base::WeakPtr<IncrementService> AsWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  int num_requests() const { return num_requests_; }
+
+  void Accept(const Message& request) override {
+    ++num_requests_;
+    Message response = request;
+    ++response.payload;
+    WriteMessage(client_, std::move(response));
+  }
+
+ private:
+  base::WeakPtr<MessageReceiver> client_;
+  int num_requests_ = 0;
+  base::WeakPtrFactory<IncrementService> weak_factory_{this};
+};
+
+class IncrementResponder : public PromiseResponder<uint64_t> {
+ public:
+  using PromiseResponder::PromiseResponder;
+
+  static int num_deserialized_responses() {
+    return num_deserialized_responses_;
+  }
+
+ private:
+  uint64_t Deserialize(const Message& response) override {
+    ++num_deserialized_responses_;
+    return response.payload;
+  }
+
+  static inline int num_deserialized_responses_ = 0;
+};
+
+struct Connection {
+  Connection() { service.set_client(client.AsWeakPtr()); }
+
+  base::Future<uint64_t> Increment(uint64_t value) {
+    Message request(kIncrementName);
+    request.payload = value;
+    return SendWithPromiseResponder<IncrementResponder>(client,
+                                                        std::move(request));
+  }
+
+  IncrementService service;
+  InterfaceEndpointClient client{service.AsWeakPtr()};
+};
+
+// Awaits a response on behalf of an object that may go away first.
+class Caller {
+ public:
+  explicit Caller(Connection* connection) : connection_(connection) {}
+
+  base::WeakPtr<Caller> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+  const std::optional<uint64_t>& result() const { return result_; }
+
+  base::Future<void> CallIncrement(uint64_t value) {
+    result_ = co_await connection_->Increment(value);
+  }
+
+ private:
+  Connection* const connection_;
+  std::optional<uint64_t> result_;
+  base::WeakPtrFactory<Caller> weak_factory_{this};
+};
+
+void TestConsumedFutureReceivesResponse() {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  std::optional<uint64_t> result;
+  connection.Increment(41).AndThen(
+      [&result](uint64_t value) { result = value; });
+  CHECK(connection.client.num_pending_responses() == 1);
+  base::RunLoop().RunUntilIdle();
+  CHECK(result == 42u);
+  CHECK(connection.client.num_pending_responses() == 0);
+}
+
+void TestDroppedFutureCancelsRequest() {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  const int num_deserialized = IncrementResponder::num_deserialized_responses();
+  connection.Increment(41);
+  CHECK(connection.client.num_pending_responses() == 0);
+  base::RunLoop().RunUntilIdle();
+  // The request was still sent, but its response is discarded unread.
+  CHECK(connection.service.num_requests() == 1);
+  CHECK(IncrementResponder::num_deserialized_responses() == num_deserialized);
+}
+
+void TestAwaitingCoroutineReceivesResponse() {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  Caller caller(&connection);
+  caller.CallIncrement(41);
+  base::RunLoop().RunUntilIdle();
+  CHECK(caller.result() == 42u);
+  CHECK(connection.client.num_pending_responses() == 0);
+}
+
+void TestDestroyedCoroutineCancelsRequest() {
+  base::SingleThreadTaskExecutor executor;
+  Connection connection;
+  const int num_deserialized = IncrementResponder::num_deserialized_responses();
+  {
+    Caller caller(&connection);
+    caller.CallIncrement(41);
+    CHECK(connection.client.num_pending_responses() == 1);
+  }
+  // Invalidating the caller's weak pointers destroyed the suspended frame,
+  // and the future it awaited with it.
+  CHECK(connection.client.num_pending_responses() == 0);
+  base::RunLoop().RunUntilIdle();
+  CHECK(connection.service.num_requests() == 1);
+  CHECK(IncrementResponder::num_deserialized_responses() == num_deserialized);
+}
+
+}  // namespace
+}  // namespace mojo
+
+int main() {
+  mojo::TestConsumedFutureReceivesResponse();
+  mojo::TestDroppedFutureCancelsRequest();
+  mojo::TestAwaitingCoroutineReceivesResponse();
+  mojo::TestDestroyedCoroutineCancelsRequest();
+  return 0;
+}